@@ -46,12 +46,23 @@ def get_field(fields, name):
             return field[1].strip()
     return None
 
+# Total length of the symbol names and the section sizes of a binary
+def get_binary_statistics(binary):
+    out = subprocess.check_output(['nm', '-P', binary], stderr=subprocess.DEVNULL)
+    symbols = sum(len(line.split()[0]) for line in out.decode('utf-8').split('\n') if line.strip() != '')
+
+    out = subprocess.check_output(['size', binary]).decode('utf-8')
+    text, data, bss = out.split('\n')[1].split()[:3]
+
+    return symbols, int(text) + int(data) + int(bss)
+
 def get_benchmark_statistics(program, source):
     source = '-DLISP_SOURCE="\\"' + source + '\\""'
+    binary = program['dir'] + '/main'
     cmd = [
         '/bin/time', '-v', 'g++', '-std=c++20',
-        '-I', program['dir'], source, program['dir'] + '/' + program['source'],
-        '-o', program['dir'] + '/main'
+        '-I', program.get('include', program['dir']), source,
+        program['dir'] + '/' + program['source'], '-o', binary
     ]
 
     proc = subprocess.Popen(' '.join(cmd), shell=True, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
@@ -67,7 +78,9 @@ def get_benchmark_statistics(program, source):
     user_time = get_field(fields, 'User time')
     max_rss = get_field(fields, 'Maximum resident set size')
 
-    return user_time, max_rss
+    symbols, sections = get_binary_statistics(binary)
+
+    return user_time, max_rss, symbols, sections
 
 data = {}
 for subsource_type, subsource in subsources.items():
@@ -94,11 +107,13 @@ for subsource_type, subsource in subsources.items():
 
             max_rss = 0
             for _ in range(0, process_iterations):
-                user_time, rss = get_benchmark_statistics(program, source)
+                user_time, rss, symbols, sections = get_benchmark_statistics(program, source)
                 user_time = float(user_time)
                 rss = float(rss)/1024 # Megabytes
+                symbols = symbols/1024 # Kilobytes
+                sections = sections/1024 # Kilobytes
                 max_rss = max(max_rss, rss)
-                data[subsource_type][program['name']].append((chars, user_time, rss))
+                data[subsource_type][program['name']].append((chars, user_time, rss, symbols, sections))
 
             if max_rss > memory_cutoff:
                 program_name = program['name']
@@ -117,11 +132,11 @@ ax_times = []
 num_programs = len(programs)
 for i, program in enumerate(programs):
     # ax = plt.subplot(2, num_programs, i + 1, sharey=ax_times[-1] if i > 0 else None)
-    ax = plt.subplot(2, num_programs, i + 1)
+    ax = plt.subplot(3, num_programs, i + 1)
 
     for item in data:
         label = program['name'] + ' ' + item
-        chars, user_time, rss = zip(*data[item][program['name']])
+        chars, user_time, rss, symbols, sections = zip(*data[item][program['name']])
         sns.lineplot(x=chars, y=user_time, ax=ax, label=label, marker='o')
 
     ax.legend()
@@ -133,12 +148,11 @@ ax_times[0].set_ylabel('Time (s)')
 ax_memory = []
 for i, program in enumerate(programs):
     # ax = plt.subplot(2, num_programs, i + 1 + num_programs, sharey=ax_memory[-1] if i > 0 else None)
-    ax = plt.subplot(2, num_programs, i + 1 + num_programs)
-    ax.set_xlabel('Source size (# of chars)')
+    ax = plt.subplot(3, num_programs, i + 1 + num_programs)
 
     for item in data:
         label = program['name'] + ' ' + item
-        chars, user_time, rss = zip(*data[item][program['name']])
+        chars, user_time, rss, symbols, sections = zip(*data[item][program['name']])
         sns.lineplot(x=chars, y=rss, ax=ax, label=label, marker='o')
 
     ax.legend()
@@ -146,8 +160,24 @@ for i, program in enumerate(programs):
 
 ax_memory[0].set_ylabel('Memory (MB)')
 
+# Create the symbol table plots
+ax_symbols = []
+for i, program in enumerate(programs):
+    ax = plt.subplot(3, num_programs, i + 1 + 2 * num_programs)
+    ax.set_xlabel('Source size (# of chars)')
+
+    for item in data:
+        label = program['name'] + ' ' + item
+        chars, user_time, rss, symbols, sections = zip(*data[item][program['name']])
+        sns.lineplot(x=chars, y=symbols, ax=ax, label=label, marker='o')
+
+    ax.legend()
+    ax_symbols.append(ax)
+
+ax_symbols[0].set_ylabel('Symbol names (KB)')
+
 # Set figure size
-plt.gcf().set_size_inches(20, 10)
+plt.gcf().set_size_inches(20, 15)
 plt.tight_layout()
 
 # Also save the plots
@@ -0,0 +1,14 @@
+#include "metacpp.hpp"
+#include "lisp.hpp"
+
+#ifndef LISP_SOURCE
+#define LISP_SOURCE "(+ 1 2)"
+#endif
+
+LISP_PROGRAM(0, LISP_SOURCE);
+using results = lisp::program_eval_t <0>;
+
+int main()
+{
+	printf("RESULTS: %s\n", metacpp::io::to_string <results> ().data());
+}
@@ -0,0 +1,930 @@
+#pragma once
+
+#include "metacpp.hpp"
+
+// Standard headers
+#include <utility>
+
+// Lisp parser
+namespace lisp {								// namespace lisp
+
+// Fundamental types
+template <long int X>
+struct Int {
+	static constexpr long int value = X;
+};
+
+template <double X>
+struct Float {
+	static constexpr double value = X;
+};
+
+// Default function dispatcher
+template <metacpp::data::constexpr_string, int Index>
+struct impl_ftn_dispatcher {
+	static constexpr bool success = false;
+	static constexpr size_t next = Index;
+};
+
+// Constructor for list types
+constexpr char impl_list_cstr[] = "list";
+constexpr metacpp::data::constexpr_string impl_list_str(impl_list_cstr, sizeof(impl_list_cstr) - 1);
+
+// Parse list
+template <metacpp::data::constexpr_string, int>
+struct impl_parse_list {};
+
+template <metacpp::data::constexpr_string Str, int Index>
+requires (impl_ftn_dispatcher <Str, Index> ::success)
+struct impl_parse_list <Str, Index> {
+	// Skip whitespace
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, impl_ftn_dispatcher <Str, Index> ::next).next;
+	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
+	using impl_current_type = typename impl_ftn_dispatcher <Str, Index> ::type;
+
+	using type = metacpp::concat_t <
+		impl_current_type,
+		typename impl_parse_list <Str, impl_next_start> ::type
+	>;
+};
+
+// Until we reach the end of the list (e.g. ')')
+template <metacpp::data::constexpr_string Str, int Index>
+requires (Str.str[Index] == ')')
+struct impl_parse_list <Str, Index> {
+	static constexpr size_t next = Index + 1;
+	using type = metacpp::data::generic_list <>;
+};
+
+// Auto type casting, decided once per node over all operands
+struct auto_type {
+	struct eInt {};
+	struct eFloat {};
+};
+
+template <typename>
+struct impl_is_float {
+	static constexpr bool value = false;
+};
+
+template <double X>
+struct impl_is_float <Float <X>> {
+	static constexpr bool value = true;
+};
+
+template <typename ... Values>
+struct impl_auto_cast {
+	using type = std::conditional_t <
+		(impl_is_float <Values> ::value || ...),
+		auto_type::eFloat,
+		auto_type::eInt
+	>;
+};
+
+// Arithmetic operations
+enum class op_type {
+	plus,
+	minus,
+	multiply,
+	divide
+};
+
+template <op_type Op, typename>
+struct impl_op {};
+
+// Variadic operations are evaluated with a single (left) fold over all the
+// operands, in the type chosen by impl_auto_cast
+template <op_type Op, typename, typename>
+struct impl_fold {};
+
+template <long int ... Xs>
+struct impl_fold <op_type::plus, auto_type::eInt, metacpp::data::generic_list <Int <Xs>...>> {
+	static constexpr long int impl_value = (... + Xs);
+	using type = Int <impl_value>;
+};
+
+template <typename ... Ts>
+struct impl_fold <op_type::plus, auto_type::eFloat, metacpp::data::generic_list <Ts...>> {
+	static constexpr double impl_value = (... + double(Ts::value));
+	using type = Float <impl_value>;
+};
+
+template <long int ... Xs>
+struct impl_fold <op_type::multiply, auto_type::eInt, metacpp::data::generic_list <Int <Xs>...>> {
+	static constexpr long int impl_value = (... * Xs);
+	using type = Int <impl_value>;
+};
+
+template <typename ... Ts>
+struct impl_fold <op_type::multiply, auto_type::eFloat, metacpp::data::generic_list <Ts...>> {
+	static constexpr double impl_value = (... * double(Ts::value));
+	using type = Float <impl_value>;
+};
+
+// ADDITION
+template <typename ... Ts>
+struct impl_op <op_type::plus, metacpp::data::generic_list <Ts...>> {
+	using type = typename impl_fold <
+		op_type::plus,
+		typename impl_auto_cast <Ts...> ::type,
+		metacpp::data::generic_list <Ts...>
+	> ::type;
+};
+
+// MULTIPLICATION
+template <typename ... Ts>
+struct impl_op <op_type::multiply, metacpp::data::generic_list <Ts...>> {
+	using type = typename impl_fold <
+		op_type::multiply,
+		typename impl_auto_cast <Ts...> ::type,
+		metacpp::data::generic_list <Ts...>
+	> ::type;
+};
+
+// SUBTRACTION
+
+// Subtraction with pure integers
+template <long int X, long int Y>
+struct impl_op <op_type::minus, metacpp::data::generic_list <Int <X>, Int <Y>>> {
+	static constexpr long int impl_value = X - Y;
+	using type = Int <impl_value>;
+};
+
+// Otherwise, upcast to double
+template <typename X, typename Y>
+struct impl_op <op_type::minus, metacpp::data::generic_list <X, Y>> {
+	static constexpr double impl_value = double(X::value) - double(Y::value);
+	using type = Float <impl_value>;
+};
+
+// DIVISION
+
+// Integer result only when perfectly divisible
+template <long int X, long int Y>
+requires (X % Y == 0)
+struct impl_op <op_type::divide, metacpp::data::generic_list <Int <X>, Int <Y>>> {
+	static constexpr long int impl_value = X / Y;
+	using type = Int <impl_value>;
+};
+
+// Otherwise, upcast to double
+template <typename X, typename Y>
+struct impl_op <op_type::divide, metacpp::data::generic_list <X, Y>> {
+	static constexpr double impl_value = double(X::value)/double(Y::value);
+	using type = Float <impl_value>;
+};
+
+// List dispatcher (starts with 'list')
+template <metacpp::data::constexpr_string Str, int Index>
+requires (metacpp::lang::match_string(Str, impl_list_str, Index).success)
+struct impl_ftn_dispatcher <Str, Index> {
+	// NOTE: successfuly matched list
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace
+		(Str, metacpp::lang::match_string(Str, impl_list_str, Index).next).next;
+
+	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
+	using type = typename impl_parse_list <Str, impl_next_start> ::type;
+
+	static constexpr bool success = true;
+};
+
+// Addition dispatcher (starts with '+')
+template <metacpp::data::constexpr_string Str, int Index>
+requires (metacpp::lang::match_char(Str, '+', Index).success)
+struct impl_ftn_dispatcher <Str, Index> {
+	// NOTE: successfuly matched plus
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+
+	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
+	static_assert(metacpp::size <impl_current_type> ::value > 0,
+		"Expected at least one argument to '+'"
+	);
+
+	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
+	using type = typename impl_op <op_type::plus, impl_current_type> ::type;
+
+	static constexpr bool success = true;
+};
+
+// Multiplication dispatcher (starts with '*')
+template <metacpp::data::constexpr_string Str, int Index>
+requires (metacpp::lang::match_char(Str, '*', Index).success)
+struct impl_ftn_dispatcher <Str, Index> {
+	// NOTE: successfuly matched plus
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+
+	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
+	static_assert(metacpp::size <impl_current_type> ::value > 0,
+		"Expected at least one argument to '*'"
+	);
+
+	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
+	using type = typename impl_op <op_type::multiply, impl_current_type> ::type;
+
+	static constexpr bool success = true;
+};
+
+// Subtraction dispatcher (starts with '-')
+template <metacpp::data::constexpr_string Str, int Index>
+requires (metacpp::lang::match_char(Str, '-', Index).success)
+struct impl_ftn_dispatcher <Str, Index> {
+	// NOTE: successfuly matched plus
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+
+	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
+	static_assert(metacpp::size <impl_current_type> ::value == 2,
+		"Expected two arguments to '-'"
+	);
+
+	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
+	using type = typename impl_op <op_type::minus, impl_current_type> ::type;
+
+	static constexpr bool success = true;
+};
+
+// Division dispatcher (starts with '/')
+template <metacpp::data::constexpr_string Str, int Index>
+requires (metacpp::lang::match_char(Str, '/', Index).success)
+struct impl_ftn_dispatcher <Str, Index> {
+	// NOTE: successfuly matched plus
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+
+	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
+	static_assert(metacpp::size <impl_current_type> ::value == 2,
+		"Expected two arguments to '/'"
+	);
+
+	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
+	using type = typename impl_op <op_type::divide, impl_current_type> ::type;
+
+	static constexpr bool success = true;
+};
+
+// Expression dispatcher (starts with '(')
+template <metacpp::data::constexpr_string Str, int Index>
+requires (metacpp::lang::match_char(Str, '(', Index).success)
+struct impl_ftn_dispatcher <Str, Index> {
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+
+	static constexpr size_t next = impl_ftn_dispatcher <Str, impl_next_start> ::next;
+	using type = metacpp::data::generic_list <
+		typename impl_ftn_dispatcher <Str, impl_next_start> ::type
+	>;
+
+	static constexpr bool success = true;
+};
+
+// Read numbers
+template <metacpp::data::constexpr_string Str, int Index>
+requires (metacpp::lang::match_float <double> (Str, Index).success)
+struct impl_ftn_dispatcher <Str, Index> {
+	static constexpr auto impl_result = metacpp::lang::match_float <double> (Str, Index);
+
+	// Skip whitespace
+	static constexpr size_t next = metacpp::lang::match_whitespace
+		(Str, impl_result.next).next;
+
+	using impl_current_type = std::conditional_t <
+		impl_result.dot,
+		Float <impl_result.value>,
+		Int <(long int)(impl_result.value)>
+	>;
+
+	using type = metacpp::data::generic_list <impl_current_type>;
+
+	static constexpr bool success = true;
+};
+
+constexpr bool impl_is_non_whitespace(const metacpp::data::constexpr_string &str, int index)
+{
+	for (int i = index; i < str.size; i++) {
+		if (str.str[i] != ' ' && str.str[i] != '\t' && str.str[i] != '\n')
+			return true;
+	}
+
+	return false;
+}
+
+// Final dispatcher (starts at beginning of string)
+template <metacpp::data::constexpr_string, int>
+struct eval {
+	using type = metacpp::data::generic_list <>;
+};
+
+template <metacpp::data::constexpr_string Str, int Index>
+requires (impl_is_non_whitespace(Str, Index))
+struct eval <Str, Index> {
+	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index).next;
+	using impl_current_type = typename impl_ftn_dispatcher <Str, impl_next_start> ::type;
+	static constexpr int impl_after_current = impl_ftn_dispatcher <Str, impl_next_start> ::next;
+
+	using type = metacpp::concat_t <
+		impl_current_type,
+		typename eval <Str, impl_after_current> ::type
+	>;
+
+	// NOTE: no next, since we expect to parse the entire string
+};
+
+template <metacpp::data::constexpr_string Str, int Index = 0>
+using eval_t = typename eval <Str, Index> ::type;
+
+// Compact evaluation: each source is registered once under a small integer
+// ID, parsed into a flat syntax tree and evaluated with constexpr functions.
+// Templates are only instantiated to materialize the result, and are keyed on
+// (program, node) so that their names do not grow with the source.
+template <int Program>
+struct program {};
+
+// Registers a source under the given ID; use at global scope
+#define LISP_PROGRAM(ID, SOURCE)						\
+	template <>								\
+	struct lisp::program <ID> {						\
+		static constexpr char impl_cstr[] = SOURCE;			\
+		static constexpr metacpp::data::constexpr_string value {	\
+			impl_cstr, sizeof(impl_cstr) - 1			\
+		};								\
+	}
+
+// Syntax tree nodes
+enum class node_kind : unsigned char {
+	integer,
+	real,
+	symbol,
+	list
+};
+
+// Builtin forms, resolved once while parsing
+enum class builtin : unsigned char {
+	none,
+	list,
+	plus,
+	minus,
+	multiply,
+	divide
+};
+
+// Result types known before evaluation
+enum class node_type : unsigned char {
+	unknown,
+	integer,
+	real,
+	list
+};
+
+struct node {
+	node_kind kind = node_kind::list;
+	builtin form = builtin::none;
+	node_type type = node_type::unknown;
+	long int integer = 0;
+	double real = 0;
+
+	// Source range
+	int begin = 0;
+	int end = 0;
+
+	// Children of lists (-1 if none)
+	int first = -1;
+	int next = -1;
+	int size = 0;
+};
+
+struct impl_builtin_entry {
+	const char *name;
+	builtin form;
+};
+
+constexpr impl_builtin_entry impl_builtins[] = {
+	{ "list", builtin::list },
+	{ "+", builtin::plus },
+	{ "-", builtin::minus },
+	{ "*", builtin::multiply },
+	{ "/", builtin::divide },
+};
+
+constexpr builtin impl_lookup_builtin(const metacpp::data::constexpr_string &str, int begin, int end)
+{
+	for (const impl_builtin_entry &entry : impl_builtins) {
+		int i = 0;
+		while (begin + i < end && entry.name[i] == str.str[begin + i])
+			i++;
+
+		if (begin + i == end && entry.name[i] == '\0')
+			return entry.form;
+	}
+
+	return builtin::none;
+}
+
+// Errors are reported with the source offset of the offending node
+enum class error_code : unsigned char {
+	none,
+	parse,
+	unknown_form,
+	arity,
+	type,
+	divide_by_zero
+};
+
+struct status {
+	error_code error = error_code::none;
+	int offset = -1;
+	int size = 0;
+};
+
+// Recursive descent parser; node 0 is the root, whose children are the
+// top-level forms. Passing a null node buffer only counts the nodes.
+struct impl_parser {
+	const metacpp::data::constexpr_string &str;
+	node *nodes;
+	status state {};
+
+	constexpr bool delimiter(int index) const {
+		char c = str.str[index];
+		return c == ' ' || c == '\t' || c == '\n' || c == '(' || c == ')';
+	}
+
+	constexpr int skip(int index) const {
+		while (index < str.size && (str.str[index] == ' '
+				|| str.str[index] == '\t'
+				|| str.str[index] == '\n'))
+			index++;
+
+		return index;
+	}
+
+	constexpr int emit(const node &n) {
+		if (nodes)
+			nodes[state.size] = n;
+
+		return state.size++;
+	}
+
+	constexpr void fail(int offset) {
+		if (state.error == error_code::none)
+			state = { error_code::parse, offset, state.size };
+	}
+
+	// Parses children until the closing parenthesis, which is only expected
+	// if the list was opened at a valid offset (i.e. not the root)
+	constexpr int children(int parent, int open, int index) {
+		int previous = -1;
+		index = skip(index);
+		while (index < str.size && str.str[index] != ')') {
+			int child = state.size;
+			index = skip(expression(index));
+			if (state.error != error_code::none)
+				return index;
+
+			if (nodes) {
+				if (previous < 0)
+					nodes[parent].first = child;
+				else
+					nodes[previous].next = child;
+
+				nodes[parent].size++;
+			}
+
+			previous = child;
+		}
+
+		if (open < 0 && index < str.size)
+			fail(index);
+		else if (open >= 0 && index >= str.size)
+			fail(open);
+
+		return index + (open >= 0);
+	}
+
+	constexpr int expression(int index) {
+		if (str.str[index] == ')') {
+			fail(index);
+			return index + 1;
+		}
+
+		if (str.str[index] == '(') {
+			int self = emit(node { .kind = node_kind::list, .begin = index });
+			int end = children(self, index, index + 1);
+			if (nodes) {
+				nodes[self].end = end;
+
+				int head = nodes[self].first;
+				if (head >= 0 && nodes[head].kind == node_kind::symbol)
+					nodes[self].form = impl_lookup_builtin(str, nodes[head].begin, nodes[head].end);
+			}
+
+			return end;
+		}
+
+		int end = index;
+		while (end < str.size && !delimiter(end))
+			end++;
+
+		auto number = metacpp::lang::match_float <double> (str, index);
+		if (number.success && number.next == end) {
+			if (number.dot) {
+				emit(node {
+					.kind = node_kind::real, .real = number.value,
+					.begin = index, .end = end
+				});
+			} else {
+				emit(node {
+					.kind = node_kind::integer,
+					.integer = metacpp::lang::match_int <long int> (str, index).value,
+					.begin = index, .end = end
+				});
+			}
+		} else {
+			emit(node { .kind = node_kind::symbol, .begin = index, .end = end });
+		}
+
+		return end;
+	}
+
+	constexpr status parse() {
+		int root = emit(node { .kind = node_kind::list, .end = int(str.size) });
+		children(root, -1, 0);
+		return state;
+	}
+};
+
+constexpr status impl_parse(const metacpp::data::constexpr_string &str, node *nodes)
+{
+	return impl_parser { str, nodes } .parse();
+}
+
+// Type inference over the whole tree; children always follow their parent,
+// so a single backwards sweep visits every operand before its form
+constexpr void impl_infer(node *nodes, int size)
+{
+	for (int i = size - 1; i >= 0; i--) {
+		node &n = nodes[i];
+		if (n.kind != node_kind::list) {
+			n.type = (n.kind == node_kind::integer) ? node_type::integer
+				: (n.kind == node_kind::real) ? node_type::real
+				: node_type::unknown;
+			continue;
+		}
+
+		if (n.form == builtin::list) {
+			n.type = node_type::list;
+			continue;
+		}
+
+		if (n.form == builtin::none)
+			continue;
+
+		// Arithmetic: integer only if every operand is, and a float
+		// operand promotes the whole node
+		bool integer = true;
+		bool real = false;
+		bool known = true;
+		for (int j = nodes[n.first].next; j >= 0; j = nodes[j].next) {
+			integer &= (nodes[j].type == node_type::integer);
+			real |= (nodes[j].type == node_type::real);
+			known &= (nodes[j].type == node_type::integer || nodes[j].type == node_type::real);
+		}
+
+		if (known && real)
+			n.type = node_type::real;
+		else if (known && integer && n.form != builtin::divide)
+			n.type = node_type::integer;
+	}
+}
+
+template <size_t N>
+constexpr std::array <node, N> impl_parse_nodes(const metacpp::data::constexpr_string &str)
+{
+	std::array <node, N> nodes {};
+	impl_parse(str, nodes.data());
+	impl_infer(nodes.data(), N);
+	return nodes;
+}
+
+// Evaluated values; lists refer to a contiguous range of elements
+enum class value_kind : unsigned char {
+	integer,
+	real,
+	list
+};
+
+struct value {
+	value_kind kind = value_kind::integer;
+	long int integer = 0;
+	double real = 0;
+
+	// Elements of lists
+	int offset = 0;
+	int size = 0;
+};
+
+// Growable buffer usable both in constant evaluation and at runtime
+template <typename T>
+struct impl_arena {
+	T *data = nullptr;
+	int size = 0;
+	int capacity = 0;
+
+	constexpr impl_arena() = default;
+	impl_arena(const impl_arena &) = delete;
+	impl_arena &operator=(const impl_arena &) = delete;
+
+	constexpr ~impl_arena() {
+		delete[] data;
+	}
+
+	constexpr int push(const T &x) {
+		if (size == capacity) {
+			capacity = capacity ? 2 * capacity : 64;
+
+			T *grown = new T[capacity] {};
+			for (int i = 0; i < size; i++)
+				grown[i] = data[i];
+
+			delete[] data;
+			data = grown;
+		}
+
+		data[size] = x;
+		return size++;
+	}
+
+	constexpr T &operator[](int index) {
+		return data[index];
+	}
+
+	constexpr const T &operator[](int index) const {
+		return data[index];
+	}
+};
+
+constexpr double impl_real(const value &v)
+{
+	return (v.kind == value_kind::real) ? v.real : double(v.integer);
+}
+
+// Tree walking evaluator; operands are gathered on the stack and list
+// elements are copied into the heap contiguously once evaluated
+struct impl_machine {
+	const metacpp::data::constexpr_string &str;
+	const node *nodes;
+	impl_arena <value> heap {};
+	impl_arena <value> stack {};
+	status state {};
+
+	constexpr bool failed() const {
+		return state.error != error_code::none;
+	}
+
+	constexpr value fail(error_code error, int index) {
+		if (!failed())
+			state = { error, nodes[index].begin, 0 };
+
+		return {};
+	}
+
+	// Evaluates the nodes first, first.next, ... onto the stack
+	constexpr int arguments(int first) {
+		int count = 0;
+		for (int i = first; i >= 0 && !failed(); i = nodes[i].next) {
+			stack.push(eval(i));
+			count++;
+		}
+
+		return count;
+	}
+
+	constexpr value make_list(int first) {
+		int base = stack.size;
+		int count = arguments(first);
+
+		value result { .kind = value_kind::list, .offset = heap.size, .size = count };
+		for (int i = 0; i < count; i++)
+			heap.push(stack[base + i]);
+
+		stack.size = base;
+		return result;
+	}
+
+	constexpr value arithmetic(int index) {
+		const node &n = nodes[index];
+
+		int base = stack.size;
+		int count = arguments(nodes[n.first].next);
+		if (failed())
+			return {};
+
+		bool binary = (n.form == builtin::minus || n.form == builtin::divide);
+		if (count == 0 || (binary && count != 2))
+			return fail(error_code::arity, index);
+
+		// Only nodes whose operands could not be inferred are checked here
+		node_type type = n.type;
+		if (type == node_type::unknown) {
+			type = node_type::integer;
+			for (int i = base; i < base + count; i++) {
+				if (stack[i].kind == value_kind::list)
+					return fail(error_code::type, index);
+
+				if (stack[i].kind == value_kind::real)
+					type = node_type::real;
+			}
+		}
+
+		// Integer division only when perfectly divisible
+		if (n.form == builtin::divide) {
+			value y = stack[base + 1];
+			if (y.kind == value_kind::real ? y.real == 0 : y.integer == 0)
+				return fail(error_code::divide_by_zero, index);
+
+			if (type == node_type::integer && stack[base].integer % y.integer != 0)
+				type = node_type::real;
+		}
+
+		value result {};
+		if (type == node_type::integer) {
+			long int x = stack[base].integer;
+			for (int i = base + 1; i < base + count; i++) {
+				long int y = stack[i].integer;
+				switch (n.form) {
+				case builtin::plus: x += y; break;
+				case builtin::minus: x -= y; break;
+				case builtin::multiply: x *= y; break;
+				default: x /= y; break;
+				}
+			}
+
+			result = { .kind = value_kind::integer, .integer = x };
+		} else {
+			double x = impl_real(stack[base]);
+			for (int i = base + 1; i < base + count; i++) {
+				double y = impl_real(stack[i]);
+				switch (n.form) {
+				case builtin::plus: x += y; break;
+				case builtin::minus: x -= y; break;
+				case builtin::multiply: x *= y; break;
+				default: x /= y; break;
+				}
+			}
+
+			result = { .kind = value_kind::real, .real = x };
+		}
+
+		stack.size = base;
+		return result;
+	}
+
+	constexpr value eval(int index) {
+		const node &n = nodes[index];
+		switch (n.kind) {
+		case node_kind::integer:
+			return { .kind = value_kind::integer, .integer = n.integer };
+		case node_kind::real:
+			return { .kind = value_kind::real, .real = n.real };
+		case node_kind::symbol:
+			return fail(error_code::unknown_form, index);
+		default:
+			break;
+		}
+
+		switch (n.form) {
+		case builtin::list:
+			return make_list(nodes[n.first].next);
+		case builtin::plus:
+		case builtin::minus:
+		case builtin::multiply:
+		case builtin::divide:
+			return arithmetic(index);
+		default:
+			return fail(error_code::unknown_form, index);
+		}
+	}
+};
+
+// Evaluates a parsed source; the result tree is laid out breadth first, so
+// that the elements of every list are contiguous and the root is at 0
+constexpr status impl_evaluate(const metacpp::data::constexpr_string &str, const node *nodes, value *out)
+{
+	impl_machine machine { str, nodes };
+	value root = machine.make_list(nodes[0].first);
+	if (machine.failed())
+		return machine.state;
+
+	impl_arena <value> flat;
+	flat.push(root);
+	for (int i = 0; i < flat.size; i++) {
+		if (flat[i].kind != value_kind::list)
+			continue;
+
+		int offset = flat.size;
+		for (int j = 0; j < flat[i].size; j++)
+			flat.push(machine.heap[flat[i].offset + j]);
+
+		flat[i].offset = offset;
+	}
+
+	if (out) {
+		for (int i = 0; i < flat.size; i++)
+			out[i] = flat[i];
+	}
+
+	return { error_code::none, -1, flat.size };
+}
+
+template <size_t N>
+constexpr std::array <value, N> impl_evaluate_values(const metacpp::data::constexpr_string &str, const node *nodes)
+{
+	std::array <value, N> values {};
+	impl_evaluate(str, nodes, values.data());
+	return values;
+}
+
+// Instantiated only on failure, to name the error and its source offset
+template <error_code Error, int Offset>
+struct impl_check {
+	static_assert(Error != error_code::parse, "lisp: malformed source");
+	static_assert(Error != error_code::unknown_form, "lisp: unknown form");
+	static_assert(Error != error_code::arity, "lisp: wrong number of arguments");
+	static_assert(Error != error_code::type, "lisp: invalid argument type");
+	static_assert(Error != error_code::divide_by_zero, "lisp: division by zero");
+
+	static constexpr bool value = true;
+};
+
+// Parsed and evaluated program, stored once per source
+template <typename Source>
+struct impl_program {
+	static constexpr const metacpp::data::constexpr_string &str = Source::value;
+
+	static constexpr status impl_parsed = impl_parse(str, nullptr);
+	static_assert(impl_check <impl_parsed.error, impl_parsed.offset> ::value);
+
+	static constexpr std::array <node, impl_parsed.size> nodes = impl_parse_nodes <impl_parsed.size> (str);
+
+	static constexpr status impl_evaluated = impl_evaluate(str, nodes.data(), nullptr);
+	static_assert(impl_check <impl_evaluated.error, impl_evaluated.offset> ::value);
+
+	static constexpr std::array <value, impl_evaluated.size> values
+		= impl_evaluate_values <impl_evaluated.size> (str, nodes.data());
+};
+
+// Materializing result types
+template <typename Source, int Index, value_kind = impl_program <Source> ::values[Index].kind>
+struct impl_materialize {};
+
+template <typename Source, int Offset, typename>
+struct impl_materialize_list {};
+
+template <typename Source, int Offset, size_t ... Is>
+struct impl_materialize_list <Source, Offset, std::index_sequence <Is...>> {
+	using type = metacpp::data::generic_list <
+		typename impl_materialize <Source, Offset + Is> ::type...
+	>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::integer> {
+	using type = Int <impl_program <Source> ::values[Index].integer>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::real> {
+	using type = Float <impl_program <Source> ::values[Index].real>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::list> {
+	static constexpr value impl_value = impl_program <Source> ::values[Index];
+
+	using type = typename impl_materialize_list <
+		Source, impl_value.offset,
+		std::make_index_sequence <impl_value.size>
+	> ::type;
+};
+
+template <int Program>
+using program_eval_t = typename impl_materialize <program <Program>, 0> ::type;
+
+}										// namespace lisp
+
+// + Meta overrrides
+namespace metacpp::io {
+
+// Printing integers
+// TODO: generate at compile time
+template <long int X>
+struct impl_printf <lisp::Int <X>> {
+	static std::string value() {
+		return std::to_string(X) + "I";
+	}
+};
+
+// Printing floats
+template <double X>
+struct impl_printf <lisp::Float <X>> {
+	static std::string value() {
+		return std::to_string(X) + "F";
+	}
+};
+
+}
@@ -0,0 +1,9 @@
+(defun range (n) (do ((i n (- i 1)) (l '() (cons (- i 1) l))) ((= i 0) l)))
+(defun square (x) (* x x))
+(reduce + 0 (map square (range 100)))
+(list (/ 1 3) (/ 6 3) (< 1 2.5) '(1.5 #f))
+(reduce + 0 (range 20))
+(expt 3 50)
+(make-vector 8 (lambda (i) (/ (square i) 49.0)))
+(concat "id_" (number->string (square 12)))
+'(get post)
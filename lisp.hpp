@@ -2,6 +2,26 @@
 
 #include "metacpp.hpp"
 
+// Standard headers
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 // Lisp parser
 namespace lisp {								// namespace lisp
 
@@ -11,331 +31,5214 @@ struct Int {
 	static constexpr long int value = X;
 };
 
-template <double X>
-struct Float {
-	static constexpr double value = X;
+template <double X>
+struct Float {
+	static constexpr double value = X;
+};
+
+template <bool X>
+struct Bool {
+	static constexpr bool value = X;
+};
+
+// Integers that do not fit in a long int, as limbs in base 2^32, least
+// significant first
+template <bool Negative, unsigned int ... Limbs>
+struct Big {
+	static constexpr bool negative = Negative;
+	static constexpr std::array <unsigned int, sizeof...(Limbs)> limbs { Limbs... };
+};
+
+// Strings held inline, so that equal strings are the same template argument,
+// e.g. String <"abc">
+template <size_t N>
+struct fixed_string {
+	char str[N + 1] {};
+
+	constexpr fixed_string() = default;
+	constexpr fixed_string(const char (&s)[N + 1]) {
+		for (size_t i = 0; i < N; i++)
+			str[i] = s[i];
+	}
+
+	constexpr size_t size() const {
+		return N;
+	}
+
+	constexpr std::string_view view() const {
+		return { str, N };
+	}
+};
+
+template <size_t N>
+fixed_string(const char (&)[N]) -> fixed_string <N - 1>;
+
+template <fixed_string S>
+struct String {
+	static constexpr std::string_view value = S.view();
+};
+
+template <fixed_string S>
+struct Symbol {
+	static constexpr std::string_view value = S.view();
+};
+
+// Sources are parsed into a flat syntax tree and evaluated with constexpr
+// functions into a flat tree of values. Templates are only instantiated to
+// materialize result types, and are keyed on (source, index).
+
+// Evaluation stops with a static_assert once parsing and evaluating a source
+// take more steps than its fuel, instead of exhausting the memory of the
+// compiler; 0 is unlimited
+#ifndef LISP_FUEL
+#define LISP_FUEL 0
+#endif
+
+// Sources can be registered once under a small integer ID, so that the names
+// of these templates do not grow with the source
+template <int Program>
+struct program {};
+
+// Sources given directly as strings
+template <metacpp::data::constexpr_string Str, long int Fuel>
+struct impl_string_source {
+	static constexpr metacpp::data::constexpr_string value = Str;
+	static constexpr long int fuel = Fuel;
+};
+
+// Registers a source under the given ID, optionally with its own fuel; use
+// at global scope
+#define LISP_PROGRAM(ID, SOURCE) LISP_PROGRAM_FUEL(ID, SOURCE, LISP_FUEL)
+
+#define LISP_PROGRAM_FUEL(ID, SOURCE, FUEL)					\
+	template <>								\
+	struct lisp::program <ID> {						\
+		static constexpr char impl_cstr[] = SOURCE;			\
+		static constexpr metacpp::data::constexpr_string value {	\
+			impl_cstr, sizeof(impl_cstr) - 1			\
+		};								\
+		static constexpr long int fuel = FUEL;				\
+	}
+
+// Same, binding tables, e.g. lisp::table { "sales", sales_csv }
+#define LISP_PROGRAM_TABLES(ID, SOURCE, ...)					\
+	template <>								\
+	struct lisp::program <ID> {						\
+		static constexpr char impl_cstr[] = SOURCE;			\
+		static constexpr metacpp::data::constexpr_string value {	\
+			impl_cstr, sizeof(impl_cstr) - 1			\
+		};								\
+		static constexpr long int fuel = LISP_FUEL;			\
+		static constexpr lisp::table tables[] = { __VA_ARGS__ };	\
+	}
+
+// Same, importing the definitions of other registered programs (modules),
+// e.g. LISP_PROGRAM_IMPORTS(2, SOURCE, 0, 1); see lisp::imports
+#define LISP_PROGRAM_IMPORTS(ID, SOURCE, ...)					\
+	template <>								\
+	struct lisp::program <ID> {						\
+		static constexpr char impl_cstr[] = SOURCE;			\
+		static constexpr metacpp::data::constexpr_string value {	\
+			impl_cstr, sizeof(impl_cstr) - 1			\
+		};								\
+		static constexpr long int fuel = LISP_FUEL;			\
+		using imports = lisp::imports <__VA_ARGS__>;			\
+	}
+
+// Splitting a program across translation units: each form is evaluated in
+// the one unit that defines it with LISP_PROGRAM_UNIT, and the others declare
+// it with LISP_PROGRAM_UNIT_EXTERN before reading program_unit <ID, FORM>
+// ::value at runtime
+#define LISP_PROGRAM_UNIT(ID, FORM)						\
+	template <>								\
+	const lisp::value_view lisp::program_unit <ID, FORM> ::value		\
+		= lisp::program_form_v <ID, FORM>
+
+#define LISP_PROGRAM_UNIT_EXTERN(ID, FORM)					\
+	template <>								\
+	const lisp::value_view lisp::program_unit <ID, FORM> ::value
+
+// Growable buffer usable both in constant evaluation and at runtime; storage
+// is only initialized when pushed to, which matters at runtime. Elements are
+// never destroyed, so slots below the constructed mark are assigned again
+// instead of constructed, which is much cheaper in constant evaluation
+template <typename T>
+struct impl_arena {
+	static_assert(std::is_trivially_destructible_v <T>);
+
+	T *data = nullptr;
+	int size = 0;
+	int capacity = 0;
+	int constructed = 0;
+
+	constexpr impl_arena() = default;
+	impl_arena(const impl_arena &) = delete;
+	impl_arena &operator=(const impl_arena &) = delete;
+
+	constexpr ~impl_arena() {
+		if (data)
+			std::allocator <T> {} .deallocate(data, capacity);
+	}
+
+	constexpr int push(const T &x) {
+		if (size == capacity) {
+			int grown_capacity = capacity ? 2 * capacity : 64;
+
+			T *grown = std::allocator <T> {} .allocate(grown_capacity);
+			for (int i = 0; i < size; i++)
+				std::construct_at(grown + i, data[i]);
+
+			// Pushing an element of the arena itself
+			std::construct_at(grown + size, x);
+			if (data)
+				std::allocator <T> {} .deallocate(data, capacity);
+
+			data = grown;
+			capacity = grown_capacity;
+			constructed = size + 1;
+			return size++;
+		}
+
+		if (size < constructed) {
+			data[size] = x;
+			return size++;
+		}
+
+		std::construct_at(data + size, x);
+		constructed = size + 1;
+		return size++;
+	}
+
+	// Grows to the given size, with value initialized elements
+	constexpr void resize(int n) {
+		while (size < n)
+			push(T {});
+
+		size = n;
+	}
+
+	constexpr void swap(impl_arena &other) {
+		std::swap(data, other.data);
+		std::swap(size, other.size);
+		std::swap(capacity, other.capacity);
+		std::swap(constructed, other.constructed);
+	}
+
+	constexpr T &operator[](int index) {
+		return data[index];
+	}
+
+	constexpr const T &operator[](int index) const {
+		return data[index];
+	}
+};
+
+// Syntax tree nodes
+enum class node_kind : unsigned char {
+	integer,
+	real,
+	boolean,
+	string,
+	symbol,
+	list
+};
+
+// Builtin forms, resolved once while parsing
+enum class builtin : unsigned char {
+	none,
+	list,
+	plus,
+	minus,
+	multiply,
+	divide,
+	power,
+
+	// Comparisons
+	less,
+	equal,
+	greater,
+
+	// Conditionals; only the operands that decide the result are evaluated
+	branch,
+	cond,
+	otherwise,
+	conjunction,
+	disjunction,
+	negation,
+
+	// Bindings
+	let,
+	sequential_let,
+
+	// Functions
+	lambda,
+	defun,
+
+	// Iteration; (loop ...) is restarted by (recur ...) and (do ...) is
+	// Scheme's
+	loop,
+	recur,
+	iterate,
+
+	// Lists; cdr shares the elements of its operand and the others copy
+	quote,
+	cons,
+	car,
+	cdr,
+	nth,
+	append,
+	length,
+	map,
+	reduce,
+
+	// Vectors of reals; #(x...) is read as (vector x...), and the fill of
+	// (make-vector size fill) may be a function of the index
+	vector,
+	make_vector,
+	vector_ref,
+
+	// Strings and symbols; (substr string begin [end]) shares the characters
+	// of its operand, and equal? compares any values structurally
+	concat,
+	substr,
+	equal_values,
+	string_to_symbol,
+	symbol_to_string,
+	number_to_string,
+
+	// Queries over tables, which are lists of column vectors of the same
+	// size; columns are numbered, and (where table predicate) calls the
+	// predicate with the cells of every row
+	select,
+	where,
+	sort_by,
+	group_by,
+	sum
+};
+
+// Result types known before evaluation
+enum class node_type : unsigned char {
+	unknown,
+	integer,
+	real,
+	boolean,
+	list
+};
+
+struct node {
+	node_kind kind = node_kind::list;
+	builtin form = builtin::none;
+	node_type type = node_type::unknown;
+	long int integer = 0;
+	double real = 0;
+
+	// Forms evaluated at once, without continuations, see impl_direct
+	bool direct = false;
+
+	// Source range
+	int begin = 0;
+	int end = 0;
+
+	// Children of lists (-1 if none)
+	int first = -1;
+	int next = -1;
+	int size = 0;
+
+	// Lexical addresses of symbols: the slot in the frame found by going
+	// up depth frames (-1 if unbound); frames (the root and functions)
+	// record their number of slots
+	int slot = -1;
+	int depth = 0;
+	int locals = 0;
+};
+
+struct impl_builtin_entry {
+	const char *name;
+	builtin form;
+};
+
+constexpr impl_builtin_entry impl_builtins[] = {
+	{ "list", builtin::list },
+	{ "+", builtin::plus },
+	{ "-", builtin::minus },
+	{ "*", builtin::multiply },
+	{ "/", builtin::divide },
+	{ "expt", builtin::power },
+	{ "<", builtin::less },
+	{ "=", builtin::equal },
+	{ ">", builtin::greater },
+	{ "if", builtin::branch },
+	{ "cond", builtin::cond },
+	{ "else", builtin::otherwise },
+	{ "and", builtin::conjunction },
+	{ "or", builtin::disjunction },
+	{ "not", builtin::negation },
+	{ "let", builtin::let },
+	{ "let*", builtin::sequential_let },
+	{ "lambda", builtin::lambda },
+	{ "defun", builtin::defun },
+	{ "loop", builtin::loop },
+	{ "recur", builtin::recur },
+	{ "do", builtin::iterate },
+	{ "quote", builtin::quote },
+	{ "cons", builtin::cons },
+	{ "car", builtin::car },
+	{ "cdr", builtin::cdr },
+	{ "nth", builtin::nth },
+	{ "append", builtin::append },
+	{ "length", builtin::length },
+	{ "map", builtin::map },
+	{ "reduce", builtin::reduce },
+	{ "vector", builtin::vector },
+	{ "make-vector", builtin::make_vector },
+	{ "vector-ref", builtin::vector_ref },
+	{ "concat", builtin::concat },
+	{ "substr", builtin::substr },
+	{ "equal?", builtin::equal_values },
+	{ "string->symbol", builtin::string_to_symbol },
+	{ "symbol->string", builtin::symbol_to_string },
+	{ "number->string", builtin::number_to_string },
+	{ "select", builtin::select },
+	{ "where", builtin::where },
+	{ "sort-by", builtin::sort_by },
+	{ "group-by", builtin::group_by },
+	{ "sum", builtin::sum },
+};
+
+constexpr builtin impl_lookup_builtin(const metacpp::data::constexpr_string &str, int begin, int end)
+{
+	for (const impl_builtin_entry &entry : impl_builtins) {
+		int i = 0;
+		while (begin + i < end && entry.name[i] == str.str[begin + i])
+			i++;
+
+		if (begin + i == end && entry.name[i] == '\0')
+			return entry.form;
+	}
+
+	return builtin::none;
+}
+
+// Builtins usable as function values, e.g. (reduce + 0 l)
+constexpr bool impl_first_class(builtin form)
+{
+	switch (form) {
+	case builtin::list:
+	case builtin::plus:
+	case builtin::minus:
+	case builtin::multiply:
+	case builtin::divide:
+	case builtin::power:
+	case builtin::less:
+	case builtin::equal:
+	case builtin::greater:
+	case builtin::negation:
+	case builtin::cons:
+	case builtin::car:
+	case builtin::cdr:
+	case builtin::nth:
+	case builtin::append:
+	case builtin::length:
+	case builtin::vector:
+	case builtin::vector_ref:
+	case builtin::concat:
+	case builtin::substr:
+	case builtin::equal_values:
+	case builtin::string_to_symbol:
+	case builtin::symbol_to_string:
+	case builtin::number_to_string:
+	case builtin::select:
+	case builtin::sort_by:
+	case builtin::group_by:
+	case builtin::sum:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Builtins whose value only depends on their operands, and that neither call
+// functions nor use the control stack
+constexpr bool impl_direct(builtin form)
+{
+	switch (form) {
+	case builtin::list:
+	case builtin::plus:
+	case builtin::minus:
+	case builtin::multiply:
+	case builtin::divide:
+	case builtin::power:
+	case builtin::less:
+	case builtin::equal:
+	case builtin::greater:
+	case builtin::negation:
+	case builtin::cons:
+	case builtin::car:
+	case builtin::cdr:
+	case builtin::nth:
+	case builtin::append:
+	case builtin::length:
+	case builtin::vector:
+	case builtin::vector_ref:
+	case builtin::concat:
+	case builtin::substr:
+	case builtin::equal_values:
+	case builtin::string_to_symbol:
+	case builtin::symbol_to_string:
+	case builtin::number_to_string:
+	case builtin::select:
+	case builtin::sort_by:
+	case builtin::group_by:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Errors are reported with the source offset of the offending node
+enum class error_code : unsigned char {
+	none,
+	parse,
+	unknown_form,
+	unbound,
+	arity,
+	type,
+	syntax,
+	divide_by_zero,
+	fuel,
+	dynamic,
+	overflow,
+	table
+};
+
+struct status {
+	error_code error = error_code::none;
+	int offset = -1;
+	int size = 0;
+};
+
+// Recursive descent parser; node 0 is the root, whose children are the
+// top-level forms. Passing a null node buffer only counts the nodes, and
+// each node is a step.
+struct impl_parser {
+	const metacpp::data::constexpr_string &str;
+	node *nodes;
+	long int fuel = std::numeric_limits <long int> ::max();
+	status state {};
+
+	constexpr bool delimiter(int index) const {
+		char c = str.str[index];
+		return c == ' ' || c == '\t' || c == '\n' || c == '(' || c == ')' || c == '\'' || c == '"';
+	}
+
+	constexpr int skip(int index) const {
+		while (index < str.size && (str.str[index] == ' '
+				|| str.str[index] == '\t'
+				|| str.str[index] == '\n'))
+			index++;
+
+		return index;
+	}
+
+	constexpr int emit(const node &n) {
+		if (nodes)
+			nodes[state.size] = n;
+
+		if (state.size >= fuel && state.error == error_code::none)
+			state = { error_code::fuel, n.begin, state.size };
+
+		return state.size++;
+	}
+
+	constexpr void fail(int offset) {
+		if (state.error == error_code::none)
+			state = { error_code::parse, offset, state.size };
+	}
+
+	// Integer literals must fit in a long int; the digits are accumulated
+	// as a negative number, so that the smallest one can be read too
+	constexpr long int integer(int begin, int end) {
+		bool negative = (str.str[begin] == '-');
+		long int value = 0;
+		bool overflow = false;
+		for (int i = begin + negative; i < end; i++) {
+			overflow |= __builtin_mul_overflow(value, 10, &value);
+			overflow |= __builtin_sub_overflow(value, str.str[i] - '0', &value);
+		}
+
+		if (!negative)
+			overflow |= __builtin_mul_overflow(value, -1, &value);
+
+		if (overflow && state.error == error_code::none)
+			state = { error_code::overflow, begin, state.size };
+
+		return value;
+	}
+
+	// Parses children until the closing parenthesis, which is only expected
+	// if the list was opened at a valid offset (i.e. not the root)
+	constexpr int children(int parent, int open, int index) {
+		int previous = -1;
+		index = skip(index);
+		while (index < str.size && str.str[index] != ')') {
+			int child = state.size;
+			index = skip(expression(index));
+			if (state.error != error_code::none)
+				return index;
+
+			if (nodes) {
+				if (previous < 0)
+					nodes[parent].first = child;
+				else
+					nodes[previous].next = child;
+
+				nodes[parent].size++;
+			}
+
+			previous = child;
+		}
+
+		if (open < 0 && index < str.size)
+			fail(index);
+		else if (open >= 0 && index >= str.size)
+			fail(open);
+
+		return index + (open >= 0);
+	}
+
+	constexpr int expression(int index) {
+		if (str.str[index] == ')') {
+			fail(index);
+			return index + 1;
+		}
+
+		// 'x is read as (quote x), with an empty head symbol
+		if (str.str[index] == '\'') {
+			int self = emit(node { .kind = node_kind::list, .form = builtin::quote, .begin = index });
+			int head = emit(node {
+				.kind = node_kind::symbol, .form = builtin::quote,
+				.begin = index, .end = index
+			});
+
+			char c = (index + 1 < str.size) ? str.str[index + 1] : ')';
+			if (c == ' ' || c == '\t' || c == '\n' || c == ')') {
+				fail(index);
+				return index + 1;
+			}
+
+			int quoted = state.size;
+			int end = expression(index + 1);
+			if (nodes) {
+				nodes[self] = {
+					.kind = node_kind::list, .form = builtin::quote,
+					.begin = index, .end = end,
+					.first = head, .size = 2
+				};
+
+				nodes[head].next = quoted;
+			}
+
+			return end;
+		}
+
+		// Strings, with \", \\ and \n escapes; the node spans the quotes
+		if (str.str[index] == '"') {
+			int end = index + 1;
+			while (end < str.size && str.str[end] != '"')
+				end += (str.str[end] == '\\') ? 2 : 1;
+
+			if (end >= str.size) {
+				fail(index);
+				return str.size;
+			}
+
+			emit(node { .kind = node_kind::string, .begin = index, .end = end + 1 });
+			return end + 1;
+		}
+
+		// #(x...) is read as (vector x...), with an empty head symbol
+		if (str.str[index] == '#' && index + 1 < str.size && str.str[index + 1] == '(') {
+			int self = emit(node { .kind = node_kind::list, .form = builtin::vector, .begin = index });
+			int head = emit(node {
+				.kind = node_kind::symbol, .form = builtin::vector,
+				.begin = index, .end = index
+			});
+
+			int end = children(self, index, index + 2);
+			if (nodes) {
+				nodes[head].next = nodes[self].first;
+				nodes[self].first = head;
+				nodes[self].size++;
+				nodes[self].end = end;
+			}
+
+			return end;
+		}
+
+		if (str.str[index] == '(') {
+			int self = emit(node { .kind = node_kind::list, .begin = index });
+			int end = children(self, index, index + 1);
+			if (nodes) {
+				nodes[self].end = end;
+
+				int head = nodes[self].first;
+				if (head >= 0 && nodes[head].kind == node_kind::symbol)
+					nodes[self].form = nodes[head].form;
+			}
+
+			return end;
+		}
+
+		int end = index;
+		while (end < str.size && !delimiter(end))
+			end++;
+
+		auto number = metacpp::lang::match_float <double> (str, index);
+		if (number.success && number.next == end) {
+			if (number.dot) {
+				emit(node {
+					.kind = node_kind::real, .real = number.value,
+					.begin = index, .end = end
+				});
+			} else {
+				emit(node {
+					.kind = node_kind::integer,
+					.integer = integer(index, end),
+					.begin = index, .end = end
+				});
+			}
+		} else if (end - index == 2 && str.str[index] == '#'
+				&& (str.str[index + 1] == 't' || str.str[index + 1] == 'f')) {
+			emit(node {
+				.kind = node_kind::boolean,
+				.integer = (str.str[index + 1] == 't'),
+				.begin = index, .end = end
+			});
+		} else {
+			emit(node {
+				.kind = node_kind::symbol,
+				.form = impl_lookup_builtin(str, index, end),
+				.begin = index, .end = end
+			});
+		}
+
+		return end;
+	}
+
+	constexpr status parse() {
+		int root = emit(node { .kind = node_kind::list, .end = int(str.size) });
+		children(root, -1, 0);
+		return state;
+	}
+};
+
+constexpr status impl_parse(const metacpp::data::constexpr_string &str, node *nodes,
+		long int fuel = std::numeric_limits <long int> ::max())
+{
+	return impl_parser { str, nodes, fuel } .parse();
+}
+
+// Type inference over the whole tree; children always follow their parent,
+// so a single backwards sweep visits every operand before its form
+constexpr node_type impl_infer_arithmetic(const node *nodes, builtin form, int first)
+{
+	// Integer only if every operand is, and a float operand promotes the
+	// whole node
+	bool integer = true;
+	bool real = false;
+	for (int i = first; i >= 0; i = nodes[i].next) {
+		if (nodes[i].type != node_type::integer && nodes[i].type != node_type::real)
+			return node_type::unknown;
+
+		integer &= (nodes[i].type == node_type::integer);
+		real |= (nodes[i].type == node_type::real);
+	}
+
+	if (real)
+		return node_type::real;
+
+	// Integer division depends on the values
+	if (integer && form != builtin::divide)
+		return node_type::integer;
+
+	return node_type::unknown;
+}
+
+constexpr void impl_infer(node *nodes, int size)
+{
+	for (int i = size - 1; i >= 0; i--) {
+		node &n = nodes[i];
+		switch (n.kind) {
+		case node_kind::integer:
+			n.type = node_type::integer;
+			continue;
+		case node_kind::real:
+			n.type = node_type::real;
+			continue;
+		case node_kind::boolean:
+			n.type = node_type::boolean;
+			continue;
+		case node_kind::string:
+		case node_kind::symbol:
+			continue;
+		default:
+			break;
+		}
+
+		int first = (n.first >= 0) ? nodes[n.first].next : -1;
+
+		// Direct forms have operands that are atoms or direct forms too
+		n.direct = impl_direct(n.form) || n.form == builtin::quote;
+		for (int i = first; i >= 0 && n.form != builtin::quote; i = nodes[i].next)
+			n.direct &= (nodes[i].kind != node_kind::list || nodes[i].direct);
+
+		switch (n.form) {
+		case builtin::list:
+		case builtin::cons:
+		case builtin::cdr:
+		case builtin::append:
+		case builtin::map:
+			n.type = node_type::list;
+			break;
+		case builtin::length:
+			n.type = node_type::integer;
+			break;
+		case builtin::quote:
+			if (first >= 0 && nodes[first].kind == node_kind::list)
+				n.type = node_type::list;
+			else if (first >= 0 && nodes[first].kind != node_kind::symbol)
+				n.type = nodes[first].type;
+			break;
+		case builtin::plus:
+		case builtin::minus:
+		case builtin::multiply:
+		case builtin::divide:
+			n.type = impl_infer_arithmetic(nodes, n.form, first);
+			break;
+		case builtin::less:
+		case builtin::equal:
+		case builtin::greater:
+		case builtin::negation:
+			n.type = node_type::boolean;
+			break;
+		case builtin::branch:
+		{
+			// Known only if both branches agree
+			int then = (first >= 0) ? nodes[first].next : -1;
+			int otherwise = (then >= 0) ? nodes[then].next : -1;
+			if (otherwise >= 0 && nodes[then].type == nodes[otherwise].type)
+				n.type = nodes[then].type;
+		}
+			break;
+		case builtin::let:
+		case builtin::sequential_let:
+		{
+			// Type of the last body expression
+			int last = first;
+			while (last >= 0 && nodes[last].next >= 0)
+				last = nodes[last].next;
+
+			if (last >= 0 && last != first)
+				n.type = nodes[last].type;
+		}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+// Parameter list of a well formed (lambda (parameters...) body...) or
+// (defun name (parameters...) body...), or -1
+constexpr int impl_parameters(const node *nodes, int index)
+{
+	const node &n = nodes[index];
+	bool defun = (n.form == builtin::defun);
+	if (n.kind != node_kind::list || n.size < 3 + defun)
+		return -1;
+
+	int parameters = nodes[n.first].next;
+	if (defun) {
+		if (nodes[parameters].kind != node_kind::symbol)
+			return -1;
+
+		parameters = nodes[parameters].next;
+	}
+
+	if (nodes[parameters].kind != node_kind::list)
+		return -1;
+
+	for (int i = nodes[parameters].first; i >= 0; i = nodes[i].next) {
+		if (nodes[i].kind != node_kind::symbol)
+			return -1;
+	}
+
+	return parameters;
+}
+
+// Whether the node is a list of bindings (symbol expression...), with at
+// most max elements each
+constexpr bool impl_bindings(const node *nodes, int index, int max)
+{
+	if (index < 0 || nodes[index].kind != node_kind::list)
+		return false;
+
+	for (int i = nodes[index].first; i >= 0; i = nodes[i].next) {
+		const node &b = nodes[i];
+		if (b.kind != node_kind::list || b.size < 2 || b.size > max
+				|| nodes[b.first].kind != node_kind::symbol)
+			return false;
+	}
+
+	return true;
+}
+
+// Tables of numbers in CSV text, bound by name in the programs they are given
+// to; each line is a row of comma separated numbers, and a first line that is
+// not numeric (e.g. the names of the columns) is skipped
+struct table {
+	metacpp::data::constexpr_string name;
+	metacpp::data::constexpr_string csv;
+
+	template <size_t N, size_t M>
+	constexpr table(const char (&name)[N], const char (&csv)[M])
+		: name(name, N - 1), csv(csv, M - 1) {}
+
+	constexpr table(std::string_view name, std::string_view csv)
+		: name(name.data(), name.size()), csv(csv.data(), csv.size()) {}
+};
+
+// Resolves every symbol reference to a lexical address once, so that
+// lookups during evaluation are constant time. Malformed binding forms are
+// left untouched and reported when (if) they are evaluated. Bindings shadow
+// builtins of the same name.
+struct impl_resolver {
+	// Names of tables are not in the source
+	struct binding {
+		int begin;
+		int end;
+		int slot;
+		int level;
+		const char *name = nullptr;
+	};
+
+	const metacpp::data::constexpr_string &str;
+	node *nodes;
+	std::span <const table> tables {};
+	impl_arena <binding> scope {};
+
+	// Frame being allocated, its nesting level and its live slots
+	int frame = 0;
+	int level = 0;
+	int slots = 0;
+
+	constexpr bool same(const binding &b, const node &n) const {
+		if (b.end - b.begin != n.end - n.begin)
+			return false;
+
+		for (int i = 0; i < b.end - b.begin; i++) {
+			if ((b.name ? b.name[i] : str.str[b.begin + i]) != str.str[n.begin + i])
+				return false;
+		}
+
+		return true;
+	}
+
+	constexpr void reference(node &n) {
+		for (int i = scope.size - 1; i >= 0; i--) {
+			if (same(scope[i], n)) {
+				n.slot = scope[i].slot;
+				n.depth = level - scope[i].level;
+				return;
+			}
+		}
+	}
+
+	constexpr void bind(node &n) {
+		n.slot = slots++;
+		if (nodes[frame].locals < slots)
+			nodes[frame].locals = slots;
+
+		scope.push({ n.begin, n.end, n.slot, level });
+	}
+
+	constexpr void let(const node &n) {
+		int bindings = nodes[n.first].next;
+		if (!impl_bindings(nodes, bindings, 2))
+			return;
+
+		int saved_scope = scope.size;
+		int saved_slots = slots;
+
+		// Sequential bindings see the previous ones, parallel ones do not
+		for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next) {
+			resolve(nodes[nodes[i].first].next);
+			if (n.form != builtin::let)
+				bind(nodes[nodes[i].first]);
+		}
+
+		if (n.form == builtin::let) {
+			for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next)
+				bind(nodes[nodes[i].first]);
+		}
+
+		for (int i = nodes[bindings].next; i >= 0; i = nodes[i].next)
+			resolve(i);
+
+		scope.size = saved_scope;
+		slots = saved_slots;
+	}
+
+	// (do ((symbol init [step])...) (test result...) body...); the initial
+	// values are outside of the scope of the symbols
+	constexpr void iteration(const node &n) {
+		int bindings = nodes[n.first].next;
+		if (!impl_bindings(nodes, bindings, 3))
+			return;
+
+		for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next)
+			resolve(nodes[nodes[i].first].next);
+
+		int saved_scope = scope.size;
+		int saved_slots = slots;
+
+		for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next)
+			bind(nodes[nodes[i].first]);
+
+		for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next) {
+			if (nodes[i].size == 3)
+				resolve(nodes[nodes[nodes[i].first].next].next);
+		}
+
+		for (int i = nodes[bindings].next; i >= 0; i = nodes[i].next)
+			resolve(i);
+
+		scope.size = saved_scope;
+		slots = saved_slots;
+	}
+
+	// Functions own a frame, starting with their parameters
+	constexpr void function(int owner) {
+		int parameters = impl_parameters(nodes, owner);
+		if (parameters < 0)
+			return;
+
+		int saved_scope = scope.size;
+		int saved_frame = frame;
+		int saved_slots = slots;
+
+		frame = owner;
+		slots = 0;
+		level++;
+
+		for (int i = nodes[parameters].first; i >= 0; i = nodes[i].next)
+			bind(nodes[i]);
+
+		for (int i = nodes[parameters].next; i >= 0; i = nodes[i].next)
+			resolve(i);
+
+		scope.size = saved_scope;
+		frame = saved_frame;
+		slots = saved_slots;
+		level--;
+	}
+
+	constexpr void resolve(int index) {
+		node &n = nodes[index];
+		if (n.kind == node_kind::symbol)
+			reference(n);
+
+		if (n.kind != node_kind::list)
+			return;
+
+		if (n.first >= 0 && nodes[n.first].kind == node_kind::symbol && nodes[n.first].form != builtin::none) {
+			reference(nodes[n.first]);
+			if (nodes[n.first].slot >= 0) {
+				nodes[n.first].form = builtin::none;
+				n.form = builtin::none;
+			}
+		}
+
+		switch (n.form) {
+		case builtin::let:
+		case builtin::sequential_let:
+		case builtin::loop:
+			let(n);
+			return;
+		case builtin::iterate:
+			iteration(n);
+			return;
+		case builtin::quote:
+			// Data
+			return;
+		case builtin::lambda:
+		case builtin::defun:
+			function(index);
+			return;
+		default:
+			break;
+		}
+
+		for (int i = n.first; i >= 0; i = nodes[i].next)
+			resolve(i);
+	}
+
+	// Tables and top-level definitions are visible to the whole program, in
+	// this order
+	constexpr void program() {
+		for (const table &t : tables) {
+			scope.push({ 0, int(t.name.size), slots++, level, t.name.str });
+			nodes[0].locals = slots;
+		}
+
+		for (int i = nodes[0].first; i >= 0; i = nodes[i].next) {
+			if (impl_parameters(nodes, i) >= 0 && nodes[i].form == builtin::defun)
+				bind(nodes[nodes[nodes[i].first].next]);
+		}
+
+		for (int i = nodes[0].first; i >= 0; i = nodes[i].next)
+			resolve(i);
+	}
+};
+
+template <size_t N>
+constexpr std::array <node, N> impl_parse_nodes(const metacpp::data::constexpr_string &str,
+		std::span <const table> tables = {})
+{
+	std::array <node, N> nodes {};
+	impl_parse(str, nodes.data());
+	impl_resolver { str, nodes.data(), tables } .program();
+	impl_infer(nodes.data(), N);
+	return nodes;
+}
+
+// Evaluated values; lists refer to a contiguous range of elements
+enum class value_kind : unsigned char {
+	integer,
+	real,
+	boolean,
+	list,
+	function,
+
+	// Integers that do not fit in a long int; their limbs are elements, as
+	// for lists, and integer holds the sign
+	big,
+
+	// Reals, as elements; once flattened, integer is the offset of the
+	// first one in the packed array of every vector's elements
+	vector,
+
+	// Characters, as integer elements; once flattened, integer is the offset
+	// of the first one in the packed (null terminated) text
+	string,
+	symbol
+};
+
+// Kinds whose elements follow offset
+constexpr bool impl_composite(value_kind kind)
+{
+	return kind == value_kind::list || kind == value_kind::big || kind == value_kind::vector
+		|| kind == value_kind::string || kind == value_kind::symbol;
+}
+
+struct value {
+	value_kind kind = value_kind::integer;
+	long int integer = 0;
+	double real = 0;
+
+	// Elements of lists, or the definition of functions
+	int offset = 0;
+	int size = 0;
+
+	// Functions keep the environment they were created in (in integer) and
+	// their parameter list (in size); builtins refer to their symbol
+	constexpr bool operator==(const value &other) const {
+		return kind == other.kind && integer == other.integer
+			&& std::bit_cast <unsigned long int> (real) == std::bit_cast <unsigned long int> (other.real)
+			&& offset == other.offset && size == other.size;
+	}
+};
+
+constexpr unsigned long int impl_hash(unsigned long int hash, const value &v)
+{
+	// Lists are identified by their offset
+	hash = (hash ^ (unsigned long int) v.kind) * 0x100000001b3ul;
+	hash = (hash ^ (unsigned long int) v.integer) * 0x100000001b3ul;
+	hash = (hash ^ std::bit_cast <unsigned long int> (v.real)) * 0x100000001b3ul;
+	return (hash ^ (unsigned long int) v.offset) * 0x100000001b3ul;
+}
+
+// Memoized calls: functions have no side effects, so results only depend on
+// the function, its environment and the arguments
+struct impl_memo_entry {
+	value function {};
+	value result {};
+	unsigned long int hash = 0;
+	int arguments = 0;
+	int count = 0;
+};
+
+struct impl_memo {
+	// Open addressing table of entry indices plus one (zero when empty);
+	// entries are never moved, so growing only rehashes indices
+	impl_arena <int> table {};
+	impl_arena <impl_memo_entry> entries {};
+	impl_arena <value> arguments {};
+
+	constexpr unsigned long int hash(const value &function, const value *args, int count) const {
+		unsigned long int h = impl_hash(0xcbf29ce484222325ul, function);
+		for (int i = 0; i < count; i++)
+			h = impl_hash(h, args[i]);
+
+		return h;
+	}
+
+	constexpr bool matches(const impl_memo_entry &entry, unsigned long int h,
+			const value &function, const value *args, int count) const {
+		if (entry.hash != h || entry.function != function || entry.count != count)
+			return false;
+
+		for (int i = 0; i < count; i++) {
+			if (arguments[entry.arguments + i] != args[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	// Slot of the entry for the call, or of the empty slot to fill
+	constexpr int find(unsigned long int h, const value &function, const value *args, int count) const {
+		int mask = table.size - 1;
+		int i = h & mask;
+		while (table[i] && !matches(entries[table[i] - 1], h, function, args, count))
+			i = (i + 1) & mask;
+
+		return i;
+	}
+
+	constexpr const value *lookup(const value &function, const value *args, int count) const {
+		if (!entries.size)
+			return nullptr;
+
+		int entry = table[find(hash(function, args, count), function, args, count)];
+		return entry ? &entries[entry - 1].result : nullptr;
+	}
+
+	constexpr void insert(const value &function, const value *args, int count, const value &result) {
+		// Keep the load factor under one half
+		if (2 * (entries.size + 1) > table.size) {
+			int size = table.size ? 2 * table.size : 64;
+			table.size = 0;
+			table.resize(size);
+			for (int e = 0; e < entries.size; e++) {
+				int i = entries[e].hash & (size - 1);
+				while (table[i])
+					i = (i + 1) & (size - 1);
+
+				table[i] = e + 1;
+			}
+		}
+
+		unsigned long int h = hash(function, args, count);
+		int slot = find(h, function, args, count);
+		table[slot] = entries.push({ function, result, h, arguments.size, count }) + 1;
+		for (int i = 0; i < count; i++)
+			arguments.push(args[i]);
+	}
+};
+
+constexpr double impl_real(const value &v)
+{
+	return (v.kind == value_kind::real) ? v.real : double(v.integer);
+}
+
+constexpr bool impl_numeric(const value &v)
+{
+	return v.kind == value_kind::integer || v.kind == value_kind::real;
+}
+
+// Bignums are never zero, as they do not fit in a long int
+constexpr bool impl_zero(const value &v)
+{
+	return v.kind == value_kind::real ? v.real == 0 : (v.kind == value_kind::integer && v.integer == 0);
+}
+
+// Arithmetic over numeric operands, in integers if the type allows; integer
+// division only when perfectly divisible. Fails on bignum operands and on
+// integer overflow, which need the evaluator's heap.
+constexpr bool impl_fold(builtin form, const value *args, int count, node_type type, value &result)
+{
+	if (type == node_type::integer) {
+		for (int i = 0; i < count; i++) {
+			if (args[i].kind != value_kind::integer)
+				return false;
+		}
+
+		long int x = args[0].integer;
+		if (form == builtin::divide) {
+			long int y = args[1].integer;
+			if (y == -1 && x == std::numeric_limits <long int> ::min())
+				return false;
+
+			if (x % y == 0) {
+				result = { .kind = value_kind::integer, .integer = x / y };
+				return true;
+			}
+		} else {
+			for (int i = 1; i < count; i++) {
+				long int y = args[i].integer;
+				bool overflow = (form == builtin::plus) ? __builtin_add_overflow(x, y, &x)
+					: (form == builtin::minus) ? __builtin_sub_overflow(x, y, &x)
+					: __builtin_mul_overflow(x, y, &x);
+
+				if (overflow)
+					return false;
+			}
+
+			result = { .kind = value_kind::integer, .integer = x };
+			return true;
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		if (args[i].kind == value_kind::big)
+			return false;
+	}
+
+	double x = impl_real(args[0]);
+	for (int i = 1; i < count; i++) {
+		double y = impl_real(args[i]);
+		switch (form) {
+		case builtin::plus: x += y; break;
+		case builtin::minus: x -= y; break;
+		case builtin::multiply: x *= y; break;
+		default: x /= y; break;
+		}
+	}
+
+	result = { .kind = value_kind::real, .real = x };
+	return true;
+}
+
+// Numbers compare exactly when both are integers
+constexpr bool impl_ordered(builtin form, const value &x, const value &y)
+{
+	int order = 0;
+	if (x.kind == value_kind::integer && y.kind == value_kind::integer)
+		order = (x.integer < y.integer) ? -1 : (x.integer > y.integer);
+	else
+		order = (impl_real(x) < impl_real(y)) ? -1 : (impl_real(x) > impl_real(y));
+
+	return (form == builtin::less) ? order < 0
+		: (form == builtin::greater) ? order > 0
+		: order == 0;
+}
+
+// Arithmetic and comparisons of two integers, as the evaluator gives them;
+// fails on other operands and on overflow, which take the general path
+constexpr bool impl_binary(builtin form, const value &x, const value &y, value &result)
+{
+	if (x.kind != value_kind::integer || y.kind != value_kind::integer)
+		return false;
+
+	long int z = 0;
+	switch (form) {
+	case builtin::plus:
+		if (__builtin_add_overflow(x.integer, y.integer, &z))
+			return false;
+		break;
+	case builtin::minus:
+		if (__builtin_sub_overflow(x.integer, y.integer, &z))
+			return false;
+		break;
+	case builtin::multiply:
+		if (__builtin_mul_overflow(x.integer, y.integer, &z))
+			return false;
+		break;
+	case builtin::less:
+		result = { .kind = value_kind::boolean, .integer = x.integer < y.integer };
+		return true;
+	case builtin::equal:
+		result = { .kind = value_kind::boolean, .integer = x.integer == y.integer };
+		return true;
+	case builtin::greater:
+		result = { .kind = value_kind::boolean, .integer = x.integer > y.integer };
+		return true;
+	default:
+		return false;
+	}
+
+	result = { .kind = value_kind::integer, .integer = z };
+	return true;
+}
+
+// Arbitrary precision integers: a sign and a magnitude in base 2^32, least
+// significant limb first and without leading zero limbs (so zero has none)
+struct bignum {
+	using limbs_type = std::vector <unsigned int>;
+
+	// Operands with fewer limbs are multiplied directly
+	static constexpr size_t karatsuba_threshold = 32;
+
+	bool negative = false;
+	limbs_type limbs;
+
+	constexpr bignum() = default;
+
+	constexpr bignum(long int x) : negative(x < 0) {
+		unsigned long int m = negative ? 0ul - (unsigned long int) x : (unsigned long int) x;
+		for (; m; m >>= 32)
+			limbs.push_back((unsigned int) m);
+	}
+
+	constexpr bignum(bool negative, limbs_type magnitude)
+			: negative(negative), limbs(std::move(magnitude)) {
+		trim(limbs);
+		if (limbs.empty())
+			this->negative = false;
+	}
+
+	constexpr bool zero() const {
+		return limbs.empty();
+	}
+
+	constexpr unsigned long int low() const {
+		unsigned long int m = 0;
+		for (size_t i = 0; i < limbs.size() && i < 2; i++)
+			m |= (unsigned long int) limbs[i] << (32 * i);
+
+		return m;
+	}
+
+	// Whether the value is a long int, and converting it
+	constexpr bool fits() const {
+		if (limbs.size() > 2)
+			return false;
+
+		return negative ? low() <= (1ul << 63) : low() < (1ul << 63);
+	}
+
+	constexpr long int to_long() const {
+		return negative ? (long int) (0ul - low()) : (long int) low();
+	}
+
+	constexpr double to_double() const {
+		double x = 0;
+		for (size_t i = limbs.size(); i-- > 0; )
+			x = x * 4294967296.0 + limbs[i];
+
+		return negative ? -x : x;
+	}
+
+	// Magnitudes
+	static constexpr void trim(limbs_type &a) {
+		while (!a.empty() && a.back() == 0)
+			a.pop_back();
+	}
+
+	static constexpr int compare(const limbs_type &a, const limbs_type &b) {
+		if (a.size() != b.size())
+			return a.size() < b.size() ? -1 : 1;
+
+		for (size_t i = a.size(); i-- > 0; ) {
+			if (a[i] != b[i])
+				return a[i] < b[i] ? -1 : 1;
+		}
+
+		return 0;
+	}
+
+	// Adds b shifted by the given number of limbs to a, which is large enough
+	static constexpr void accumulate(limbs_type &a, const limbs_type &b, size_t shift) {
+		unsigned long int carry = 0;
+		size_t i = 0;
+		for (; i < b.size() || carry; i++) {
+			carry += (unsigned long int) a[shift + i] + (i < b.size() ? b[i] : 0);
+			a[shift + i] = (unsigned int) carry;
+			carry >>= 32;
+		}
+	}
+
+	static constexpr limbs_type add(const limbs_type &a, const limbs_type &b) {
+		limbs_type result(std::max(a.size(), b.size()) + 1);
+		accumulate(result, a, 0);
+		accumulate(result, b, 0);
+		trim(result);
+		return result;
+	}
+
+	// Requires a >= b
+	static constexpr limbs_type subtract(const limbs_type &a, const limbs_type &b) {
+		limbs_type result = a;
+		long int borrow = 0;
+		for (size_t i = 0; i < result.size(); i++) {
+			long int x = (long int) result[i] - borrow - (i < b.size() ? (long int) b[i] : 0);
+			borrow = (x < 0);
+			result[i] = (unsigned int) x;
+		}
+
+		trim(result);
+		return result;
+	}
+
+	static constexpr limbs_type schoolbook(const limbs_type &a, const limbs_type &b) {
+		limbs_type result(a.size() + b.size());
+		for (size_t i = 0; i < a.size(); i++) {
+			unsigned long int carry = 0;
+			for (size_t j = 0; j < b.size(); j++) {
+				carry += (unsigned long int) a[i] * b[j] + result[i + j];
+				result[i + j] = (unsigned int) carry;
+				carry >>= 32;
+			}
+
+			result[i + b.size()] = (unsigned int) carry;
+		}
+
+		trim(result);
+		return result;
+	}
+
+	// Karatsuba: with a = a1 B + a0 and b = b1 B + b0, the middle term
+	// a1 b0 + a0 b1 is (a0 + a1)(b0 + b1) - a0 b0 - a1 b1
+	static constexpr limbs_type multiply(const limbs_type &a, const limbs_type &b) {
+		if (a.size() < karatsuba_threshold || b.size() < karatsuba_threshold)
+			return schoolbook(a, b);
+
+		size_t half = std::max(a.size(), b.size()) / 2;
+		auto low = [half](const limbs_type &x) {
+			limbs_type result(x.begin(), x.begin() + std::min(half, x.size()));
+			trim(result);
+			return result;
+		};
+
+		auto high = [half](const limbs_type &x) {
+			limbs_type result;
+			if (x.size() > half)
+				result.assign(x.begin() + half, x.end());
+
+			return result;
+		};
+
+		limbs_type a0 = low(a), a1 = high(a);
+		limbs_type b0 = low(b), b1 = high(b);
+		limbs_type z0 = multiply(a0, b0);
+		limbs_type z2 = multiply(a1, b1);
+		limbs_type z1 = subtract(subtract(multiply(add(a0, a1), add(b0, b1)), z0), z2);
+
+		limbs_type result(a.size() + b.size() + 1);
+		accumulate(result, z0, 0);
+		accumulate(result, z1, half);
+		accumulate(result, z2, 2 * half);
+		trim(result);
+		return result;
+	}
+
+	// Long division (Knuth's algorithm D) of magnitudes, b not zero
+	static constexpr void divide(const limbs_type &a, const limbs_type &b, limbs_type &quotient, limbs_type &remainder) {
+		if (compare(a, b) < 0) {
+			quotient = {};
+			remainder = a;
+			return;
+		}
+
+		if (b.size() == 1) {
+			quotient.assign(a.size(), 0);
+			unsigned long int rest = 0;
+			for (size_t i = a.size(); i-- > 0; ) {
+				unsigned long int x = (rest << 32) | a[i];
+				quotient[i] = (unsigned int) (x / b[0]);
+				rest = x % b[0];
+			}
+
+			trim(quotient);
+			remainder.clear();
+			if (rest)
+				remainder.push_back((unsigned int) rest);
+
+			return;
+		}
+
+		// Normalized so that the top limb of the divisor has its high bit set
+		int shift = std::countl_zero(b.back());
+		auto normalize = [shift](const limbs_type &x, size_t size) {
+			limbs_type result(size);
+			for (size_t i = 0; i < x.size(); i++) {
+				unsigned long int shifted = (unsigned long int) x[i] << shift;
+				result[i] |= (unsigned int) shifted;
+				if (i + 1 < size)
+					result[i + 1] |= (unsigned int) (shifted >> 32);
+			}
+
+			return result;
+		};
+
+		size_t n = b.size();
+		size_t m = a.size() - n;
+		limbs_type u = normalize(a, a.size() + 1);
+		limbs_type v = normalize(b, n);
+
+		quotient.assign(m + 1, 0);
+		for (size_t j = m + 1; j-- > 0; ) {
+			unsigned long int x = ((unsigned long int) u[j + n] << 32) | u[j + n - 1];
+			unsigned long int q = x / v[n - 1];
+			unsigned long int r = x % v[n - 1];
+			while (q >> 32 || q * v[n - 2] > ((r << 32) | u[j + n - 2])) {
+				q--;
+				r += v[n - 1];
+				if (r >> 32)
+					break;
+			}
+
+			// Subtracts q v, and adds v back if that was one too many
+			long int borrow = 0;
+			unsigned long int carry = 0;
+			for (size_t i = 0; i < n; i++) {
+				unsigned long int p = q * v[i] + carry;
+				carry = p >> 32;
+
+				long int t = (long int) u[i + j] - borrow - (long int) (p & 0xffffffffu);
+				u[i + j] = (unsigned int) t;
+				borrow = (t < 0);
+			}
+
+			long int t = (long int) u[j + n] - borrow - (long int) carry;
+			u[j + n] = (unsigned int) t;
+			if (t < 0) {
+				q--;
+				carry = 0;
+				for (size_t i = 0; i < n; i++) {
+					carry += (unsigned long int) u[i + j] + v[i];
+					u[i + j] = (unsigned int) carry;
+					carry >>= 32;
+				}
+
+				u[j + n] += (unsigned int) carry;
+			}
+
+			quotient[j] = (unsigned int) q;
+		}
+
+		trim(quotient);
+		remainder.assign(n, 0);
+		for (size_t i = 0; i < n; i++) {
+			unsigned long int x = u[i] >> shift;
+			if (shift)
+				x |= ((unsigned long int) u[i + 1] << (32 - shift)) & 0xffffffffu;
+
+			remainder[i] = (unsigned int) x;
+		}
+
+		trim(remainder);
+	}
+
+	// Signed arithmetic; division truncates like C++
+	constexpr bignum operator-() const {
+		return { !negative, limbs };
+	}
+
+	friend constexpr bignum operator+(const bignum &x, const bignum &y) {
+		if (x.negative == y.negative)
+			return { x.negative, add(x.limbs, y.limbs) };
+
+		if (compare(x.limbs, y.limbs) >= 0)
+			return { x.negative, subtract(x.limbs, y.limbs) };
+
+		return { y.negative, subtract(y.limbs, x.limbs) };
+	}
+
+	friend constexpr bignum operator-(const bignum &x, const bignum &y) {
+		return x + -y;
+	}
+
+	friend constexpr bignum operator*(const bignum &x, const bignum &y) {
+		return { x.negative != y.negative, multiply(x.limbs, y.limbs) };
+	}
+
+	friend constexpr std::pair <bignum, bignum> divmod(const bignum &x, const bignum &y) {
+		limbs_type quotient;
+		limbs_type remainder;
+		divide(x.limbs, y.limbs, quotient, remainder);
+		return {
+			bignum { x.negative != y.negative, std::move(quotient) },
+			bignum { x.negative, std::move(remainder) }
+		};
+	}
+
+	friend constexpr bignum pow(bignum x, unsigned long int exponent) {
+		bignum result = 1;
+		for (; exponent; exponent >>= 1) {
+			if (exponent & 1)
+				result = result * x;
+
+			if (exponent > 1)
+				x = x * x;
+		}
+
+		return result;
+	}
+
+	static constexpr int compare(const bignum &x, const bignum &y) {
+		if (x.negative != y.negative)
+			return x.negative ? -1 : 1;
+
+		int order = compare(x.limbs, y.limbs);
+		return x.negative ? -order : order;
+	}
+
+	friend constexpr bool operator==(const bignum &x, const bignum &y) = default;
+
+	// Decimal digits, nine at a time
+	constexpr std::string to_string() const {
+		if (zero())
+			return "0";
+
+		std::string digits;
+		limbs_type rest = limbs;
+		limbs_type quotient;
+		limbs_type remainder;
+		while (!rest.empty()) {
+			divide(rest, { 1000000000u }, quotient, remainder);
+			unsigned int chunk = remainder.empty() ? 0 : remainder[0];
+			for (int i = 0; i < 9 && (chunk || !quotient.empty()); i++) {
+				digits.push_back(char('0' + chunk % 10));
+				chunk /= 10;
+			}
+
+			rest.swap(quotient);
+		}
+
+		if (negative)
+			digits.push_back('-');
+
+		return { digits.rbegin(), digits.rend() };
+	}
+};
+
+// Only #f is false
+constexpr bool impl_truthy(const value &v)
+{
+	return v.kind != value_kind::boolean || v.integer;
+}
+
+// Heap slots reserved for cons; not a value functions can have
+constexpr value impl_free_slot { .kind = value_kind::function, .offset = -1 };
+
+// Only free slots are functions without a definition
+constexpr bool impl_free(const value &v)
+{
+	return v.offset < 0 && v.kind == value_kind::function;
+}
+
+// Evaluation steps waiting for the values of their operands. They are kept
+// on an explicit stack rather than in nested constexpr calls, so that the
+// depth of programs is only limited by -fconstexpr-ops-limit.
+enum class impl_step : unsigned char {
+	operands,
+	sequence,
+	branch,
+	cond,
+	logical,
+	let,
+	loop,
+	iterate,
+	traverse,
+	ret
+};
+
+struct impl_continuation {
+	impl_step step = impl_step::operands;
+	int index = 0;
+
+	// Next node to evaluate, and the size of the stack when starting
+	int cursor = -1;
+	int base = 0;
+
+	// Stage of (do ...), or whether a return is memoized
+	int phase = 0;
+
+	// Caller of returns
+	int frame = -1;
+	int owner = 0;
+};
+
+constexpr int impl_steps_per_round = 1 << 16;
+
+// Stages of (do ...)
+enum : int {
+	impl_do_init,
+	impl_do_test,
+	impl_do_body,
+	impl_do_step
+};
+
+// Evaluator; operands are gathered on the stack and list elements are copied
+// into the heap contiguously once evaluated
+struct impl_machine {
+	const metacpp::data::constexpr_string &str;
+	const node *nodes;
+	std::span <const table> tables {};
+	impl_arena <value> heap {};
+	impl_arena <value> stack {};
+	impl_arena <impl_continuation> control {};
+	status state {};
+
+	// Frames hold a link to the environment of their function followed by
+	// their slots. Functions capture a copy of the frame they are created in
+	// (an environment) on the heap, so frames are freed on return.
+	impl_arena <value> frames {};
+	int frame = -1;
+	int owner = 0;
+
+	// Either the next node to evaluate, or -1 when its value is in result
+	int next = -1;
+	value result {};
+
+	// Steps taken (starting or resuming a form), and by each top-level form
+	long int fuel = std::numeric_limits <long int> ::max();
+	long int steps = 0;
+	impl_arena <long int> costs {};
+
+	impl_memo memo {};
+
+	constexpr bool failed() const {
+		return state.error != error_code::none;
+	}
+
+	constexpr value fail(error_code error, int index) {
+		if (!failed())
+			state = { error, nodes[index].begin, 0 };
+
+		return {};
+	}
+
+	constexpr void evaluate(int index) {
+		next = index;
+	}
+
+	constexpr void give(const value &v) {
+		next = -1;
+		result = v;
+	}
+
+	constexpr void push(impl_step step, int index, int cursor) {
+		control.push({ step, index, cursor, stack.size });
+	}
+
+	constexpr impl_continuation &top() {
+		return control[control.size - 1];
+	}
+
+	constexpr int push_frame(int owner, int parent) {
+		int base = frames.push({ .offset = parent });
+		for (int i = 0; i < nodes[owner].locals; i++)
+			frames.push({});
+
+		return base;
+	}
+
+	constexpr value &local(const node &n) {
+		if (n.depth == 0)
+			return frames[frame + 1 + n.slot];
+
+		int environment = frames[frame].offset;
+		for (int i = 1; i < n.depth; i++)
+			environment = heap[environment].offset;
+
+		return heap[environment + 1 + n.slot];
+	}
+
+	constexpr int capture() {
+		int environment = heap.size;
+		for (int i = frame; i <= frame + nodes[owner].locals; i++)
+			heap.push(frames[i]);
+
+		return environment;
+	}
+
+	// Literals and symbols
+	constexpr value atom(int index) {
+		const node &n = nodes[index];
+		if (n.slot >= 0 && n.depth == 0)
+			return frames[frame + 1 + n.slot];
+
+		switch (n.kind) {
+		case node_kind::integer:
+			return { .kind = value_kind::integer, .integer = n.integer };
+		case node_kind::real:
+			return { .kind = value_kind::real, .real = n.real };
+		case node_kind::boolean:
+			return { .kind = value_kind::boolean, .integer = n.integer };
+		case node_kind::string:
+			return literal(index);
+		default:
+			if (n.slot >= 0)
+				return local(n);
+
+			// Builtins that evaluate all their operands are functions
+			if (impl_first_class(n.form))
+				return { .kind = value_kind::function, .offset = index };
+
+			return fail(error_code::unbound, index);
+		}
+	}
+
+	// Strings and symbols of the given characters, copied to the heap
+	constexpr value text(value_kind kind, const char *chars, int size) {
+		value result { .kind = kind, .offset = heap.size, .size = size };
+		for (int i = 0; i < size; i++)
+			heap.push({ .kind = value_kind::integer, .integer = chars[i] });
+
+		return result;
+	}
+
+	constexpr value literal(int index) {
+		const node &n = nodes[index];
+		value result { .kind = value_kind::string, .offset = heap.size };
+		for (int i = n.begin + 1; i < n.end - 1; i++) {
+			char c = str.str[i];
+			if (c == '\\') {
+				c = str.str[++i];
+				c = (c == 'n') ? '\n' : c;
+			}
+
+			heap.push({ .kind = value_kind::integer, .integer = c });
+			result.size++;
+		}
+
+		return result;
+	}
+
+	// Quoted symbols; the heads read from ' and #( are named by their form
+	constexpr value symbol(int index) {
+		const node &n = nodes[index];
+		if (n.begin < n.end)
+			return text(value_kind::symbol, str.str + n.begin, n.end - n.begin);
+
+		for (const impl_builtin_entry &entry : impl_builtins) {
+			if (entry.form == n.form)
+				return text(value_kind::symbol, entry.name, std::string_view(entry.name).size());
+		}
+
+		return fail(error_code::type, index);
+	}
+
+	// Moves the values on the stack from base into a new list
+	constexpr value pack(int base) {
+		value result { .kind = value_kind::list, .offset = heap.size, .size = stack.size - base };
+		for (int i = base; i < stack.size; i++)
+			heap.push(stack[i]);
+
+		stack.size = base;
+		return result;
+	}
+
+	// Same for vectors, whose elements are converted to reals
+	constexpr value pack_vector(int index, int base) {
+		value result { .kind = value_kind::vector, .offset = heap.size, .size = stack.size - base };
+		for (int i = base; i < stack.size; i++) {
+			if (!impl_numeric(stack[i]) && stack[i].kind != value_kind::big)
+				return fail(error_code::type, index);
+
+			heap.push({ .kind = value_kind::real, .real = real(stack[i]) });
+		}
+
+		stack.size = base;
+		return result;
+	}
+
+	constexpr value arithmetic(int index, int base) {
+		const node &n = nodes[index];
+		const value *args = &stack[base];
+		int count = stack.size - base;
+
+		bool binary = (n.form == builtin::minus || n.form == builtin::divide);
+		if (count == 0 || (binary && count != 2))
+			return fail(error_code::arity, index);
+
+		// Only nodes whose operands could not be inferred are checked here
+		node_type type = n.type;
+		if (type == node_type::unknown) {
+			type = node_type::integer;
+			for (int i = 0; i < count; i++) {
+				if (!impl_numeric(args[i]) && args[i].kind != value_kind::big)
+					return fail(error_code::type, index);
+
+				if (args[i].kind == value_kind::real)
+					type = node_type::real;
+			}
+		}
+
+		if (n.form == builtin::divide && impl_zero(args[1]))
+			return fail(error_code::divide_by_zero, index);
+
+		value result {};
+		if (!impl_fold(n.form, args, count, type, result))
+			result = widened(n.form, base, count);
+
+		stack.size = base;
+		return result;
+	}
+
+	// Integers that do not fit in a long int are bignums, with their limbs
+	// on the heap
+	constexpr bignum widen(const value &v) const {
+		if (v.kind != value_kind::big)
+			return v.integer;
+
+		bignum::limbs_type limbs(v.size);
+		for (int i = 0; i < v.size; i++)
+			limbs[i] = (unsigned int) heap[v.offset + i].integer;
+
+		return { bool(v.integer), std::move(limbs) };
+	}
+
+	constexpr value narrow(const bignum &x) {
+		if (x.fits())
+			return { .kind = value_kind::integer, .integer = x.to_long() };
+
+		int offset = heap.size;
+		for (unsigned int limb : x.limbs)
+			heap.push({ .kind = value_kind::integer, .integer = limb });
+
+		return { .kind = value_kind::big, .integer = x.negative, .offset = offset, .size = int(x.limbs.size()) };
+	}
+
+	constexpr double real(const value &v) const {
+		return (v.kind == value_kind::big) ? widen(v).to_double() : impl_real(v);
+	}
+
+	// Arithmetic on operands that overflow or are bignums, which are only
+	// inexact with a real operand or a remainder
+	constexpr value widened(builtin form, int base, int count) {
+		bool inexact = false;
+		for (int i = base; i < base + count; i++)
+			inexact |= (stack[i].kind == value_kind::real);
+
+		if (inexact) {
+			for (int i = base; i < base + count; i++)
+				stack[i] = { .kind = value_kind::real, .real = real(stack[i]) };
+
+			value result {};
+			impl_fold(form, &stack[base], count, node_type::real, result);
+			return result;
+		}
+
+		bignum x = widen(stack[base]);
+		if (form == builtin::divide) {
+			bignum y = widen(stack[base + 1]);
+			auto [quotient, remainder] = divmod(x, y);
+			if (!remainder.zero())
+				return { .kind = value_kind::real, .real = x.to_double() / y.to_double() };
+
+			return narrow(quotient);
+		}
+
+		for (int i = base + 1; i < base + count; i++) {
+			bignum y = widen(stack[i]);
+			if (form == builtin::plus)
+				x = x + y;
+			else if (form == builtin::minus)
+				x = x - y;
+			else
+				x = x * y;
+		}
+
+		return narrow(x);
+	}
+
+	constexpr bool ordered(builtin form, const value &x, const value &y) const {
+		if (x.kind != value_kind::big && y.kind != value_kind::big)
+			return impl_ordered(form, x, y);
+
+		int order = 0;
+		if (x.kind == value_kind::real || y.kind == value_kind::real)
+			order = (real(x) < real(y)) ? -1 : (real(x) > real(y));
+		else
+			order = bignum::compare(widen(x), widen(y));
+
+		return (form == builtin::less) ? order < 0
+			: (form == builtin::greater) ? order > 0
+			: order == 0;
+	}
+
+	// (expt base exponent), exact for integers; exponents are non-negative
+	// integers
+	constexpr value power(int index, int base) {
+		if (stack.size - base != 2)
+			return fail(error_code::arity, index);
+
+		value x = stack[base];
+		value exponent = stack[base + 1];
+		if (exponent.kind != value_kind::integer || exponent.integer < 0)
+			return fail(error_code::type, index);
+
+		if (!impl_numeric(x) && x.kind != value_kind::big)
+			return fail(error_code::type, index);
+
+		stack.size = base;
+		if (x.kind == value_kind::real) {
+			double result = 1;
+			for (unsigned long int e = exponent.integer; e; e >>= 1) {
+				if (e & 1)
+					result *= x.real;
+
+				x.real *= x.real;
+			}
+
+			return { .kind = value_kind::real, .real = result };
+		}
+
+		return narrow(pow(widen(x), exponent.integer));
+	}
+
+	// Chained comparisons, e.g. (< a b c)
+	constexpr value compare(int index, int base) {
+		const node &n = nodes[index];
+		int count = stack.size - base;
+		if (count < 2)
+			return fail(error_code::arity, index);
+
+		bool result = true;
+		for (int i = base; i < base + count; i++) {
+			if (!impl_numeric(stack[i]) && stack[i].kind != value_kind::big)
+				return fail(error_code::type, index);
+
+			if (i == base)
+				continue;
+
+			result &= ordered(n.form, stack[i - 1], stack[i]);
+		}
+
+		stack.size = base;
+		return { .kind = value_kind::boolean, .integer = result };
+	}
+
+	constexpr value negation(int index, int base) {
+		if (stack.size - base != 1)
+			return fail(error_code::arity, index);
+
+		stack.size = base;
+		return { .kind = value_kind::boolean, .integer = !impl_truthy(stack[base]) };
+	}
+
+	// Evaluates the node at the cursor of the step on top, which is popped
+	// before the last one so that it is evaluated in tail position
+	constexpr void advance() {
+		impl_continuation &k = top();
+		int i = k.cursor;
+		if (nodes[i].next < 0)
+			control.size--;
+		else
+			k.cursor = nodes[i].next;
+
+		evaluate(i);
+	}
+
+	// Evaluates the nodes first, first.next, ... and yields the last value
+	constexpr void sequence(int first) {
+		if (nodes[first].next < 0) {
+			evaluate(first);
+			return;
+		}
+
+		push(impl_step::sequence, first, first);
+		advance();
+	}
+
+	// Evaluates the operands from the cursor onto the stack, literals,
+	// symbols and direct forms at once, then applies the form; a
+	// continuation is only kept while another form is evaluated
+	constexpr void operands(int index, int cursor, int base, bool resumed) {
+		while (cursor >= 0 && !failed()) {
+			int i = cursor;
+			cursor = nodes[i].next;
+			if (nodes[i].kind != node_kind::list) {
+				stack.push(atom(i));
+			} else if (nodes[i].direct) {
+				stack.push(settle(i));
+			} else {
+				if (resumed)
+					top().cursor = cursor;
+				else
+					control.push({ impl_step::operands, index, cursor, base });
+
+				evaluate(i);
+				return;
+			}
+		}
+
+		if (failed())
+			return;
+
+		if (resumed)
+			control.size--;
+
+		finish(index, base);
+	}
+
+	// Values of direct forms, from their operands on the stack from base
+	constexpr value immediate(int index, int base) {
+		switch (nodes[index].form) {
+		case builtin::list:
+			return pack(base);
+		case builtin::plus:
+		case builtin::minus:
+		case builtin::multiply:
+		case builtin::divide:
+			return arithmetic(index, base);
+		case builtin::power:
+			return power(index, base);
+		case builtin::less:
+		case builtin::equal:
+		case builtin::greater:
+			return compare(index, base);
+		case builtin::negation:
+			return negation(index, base);
+		case builtin::cons:
+		case builtin::car:
+		case builtin::cdr:
+		case builtin::nth:
+		case builtin::append:
+		case builtin::length:
+			return primitive(index, base);
+		case builtin::vector:
+			return pack_vector(index, base);
+		case builtin::vector_ref:
+			return vector_ref(index, base);
+		case builtin::concat:
+		case builtin::substr:
+		case builtin::equal_values:
+		case builtin::string_to_symbol:
+		case builtin::symbol_to_string:
+		case builtin::number_to_string:
+			return strings(index, base);
+		default:
+			return query(index, base);
+		}
+	}
+
+	// Direct forms and their operands are evaluated at once, with the steps
+	// that starting each list operand and resuming with its value would take
+	constexpr value direct(int index) {
+		const node &n = nodes[index];
+		if (n.kind != node_kind::list)
+			return atom(index);
+
+		if (n.form == builtin::quote)
+			return quote(index);
+
+		// The usual cases of one or two operands need no stack: integer
+		// arithmetic (unless inferred as reals), comparisons and pairs
+		if (n.size == 2) {
+			int a = nodes[n.first].next;
+			value x = (nodes[a].kind == node_kind::list) ? settle(a) : atom(a);
+			if (failed())
+				return {};
+
+			if (x.kind == value_kind::list && x.size > 0) {
+				if (n.form == builtin::car)
+					return heap[x.offset];
+
+				if (n.form == builtin::cdr)
+					return { .kind = value_kind::list, .offset = x.offset + 1, .size = x.size - 1 };
+			}
+
+			int base = stack.size;
+			stack.push(x);
+			return immediate(index, base);
+		}
+
+		if (n.size == 3 && n.type != node_type::real) {
+			int a = nodes[n.first].next;
+			value x = (nodes[a].kind == node_kind::list) ? settle(a) : atom(a);
+			if (failed())
+				return {};
+
+			int b = nodes[a].next;
+			value y = (nodes[b].kind == node_kind::list) ? settle(b) : atom(b);
+			if (failed())
+				return {};
+
+			value result {};
+			if (impl_binary(n.form, x, y, result))
+				return result;
+
+			if (n.form == builtin::cons && y.kind == value_kind::list)
+				return cons(x, y);
+
+			int base = stack.size;
+			stack.push(x);
+			stack.push(y);
+			return immediate(index, base);
+		}
+
+		int base = stack.size;
+		for (int i = nodes[n.first].next; i >= 0; i = nodes[i].next) {
+			value v = (nodes[i].kind == node_kind::list) ? settle(i) : atom(i);
+			if (failed())
+				return {};
+
+			stack.push(v);
+		}
+
+		return immediate(index, base);
+	}
+
+	// Atoms or direct forms in place of a form that would be started
+	constexpr value settle(int index) {
+		steps += 2;
+		if (steps > fuel)
+			return fail(error_code::fuel, index);
+
+		return direct(index);
+	}
+
+	// Applies the form to its operands on the stack from base
+	constexpr void finish(int index, int base) {
+		builtin form = nodes[index].form;
+		if (impl_direct(form)) {
+			give(immediate(index, base));
+			return;
+		}
+
+		switch (form) {
+		case builtin::recur:
+			recur(index, base);
+			break;
+		case builtin::map:
+		case builtin::reduce:
+		case builtin::where:
+			traverse(index, base);
+			break;
+		case builtin::make_vector:
+			make_vector(index, base);
+			break;
+		case builtin::sum:
+			if (stack.size - base == 2 && stack[base + 1].kind == value_kind::function)
+				traverse(index, base);
+			else
+				give(query(index, base));
+			break;
+		default:
+			apply(index, base);
+			break;
+		}
+	}
+
+	// (if test then [else]); without an else branch the result is #f
+	constexpr void branch(int index) {
+		const node &n = nodes[index];
+		if (n.size != 3 && n.size != 4) {
+			fail(error_code::arity, index);
+			return;
+		}
+
+		int test = nodes[n.first].next;
+		if (nodes[test].kind == node_kind::list && !nodes[test].direct) {
+			push(impl_step::branch, index, -1);
+			evaluate(test);
+			return;
+		}
+
+		give(settle(test));
+		if (!failed())
+			choose(index);
+	}
+
+	constexpr void choose(int index) {
+		int then = nodes[nodes[nodes[index].first].next].next;
+		if (impl_truthy(result))
+			evaluate(then);
+		else if (nodes[then].next >= 0)
+			evaluate(nodes[then].next);
+		else
+			give({ .kind = value_kind::boolean, .integer = false });
+	}
+
+	// (cond (test body...)... [(else body...)]); tests the clause at the
+	// cursor, and a clause without a body yields its test
+	constexpr void clause() {
+		impl_continuation &k = top();
+		if (k.cursor < 0) {
+			control.size--;
+			give({ .kind = value_kind::boolean, .integer = false });
+			return;
+		}
+
+		const node &c = nodes[k.cursor];
+		if (c.kind != node_kind::list || c.size == 0) {
+			fail(error_code::syntax, k.cursor);
+			return;
+		}
+
+		if (nodes[c.first].form != builtin::otherwise) {
+			evaluate(c.first);
+			return;
+		}
+
+		give({ .kind = value_kind::boolean, .integer = true });
+		select();
+	}
+
+	constexpr void select() {
+		impl_continuation &k = top();
+		if (!impl_truthy(result)) {
+			k.cursor = nodes[k.cursor].next;
+			clause();
+			return;
+		}
+
+		const node &c = nodes[k.cursor];
+		control.size--;
+
+		if (c.size > 1)
+			sequence(nodes[c.first].next);
+	}
+
+	// (and ...) stops at the first false value, (or ...) at the first true
+	constexpr void logical(int index) {
+		const node &n = nodes[index];
+		int first = nodes[n.first].next;
+		if (first < 0) {
+			give({ .kind = value_kind::boolean, .integer = n.form == builtin::conjunction });
+			return;
+		}
+
+		push(impl_step::logical, index, first);
+		advance();
+	}
+
+	// (let ((symbol expression)...) body...); bindings are evaluated once
+	// into their slots, parallel ones all before being stored. (loop ...)
+	// binds sequentially, and stays on the stack while its body runs.
+	constexpr void let(int index) {
+		const node &n = nodes[index];
+		if (n.size < 3) {
+			fail(error_code::arity, index);
+			return;
+		}
+
+		int bindings = nodes[n.first].next;
+		if (!impl_bindings(nodes, bindings, 2)) {
+			fail(error_code::syntax, bindings);
+			return;
+		}
+
+		push(impl_step::let, index, nodes[bindings].first);
+		bind();
+	}
+
+	// Evaluates the binding at the cursor, then the body
+	constexpr void bind() {
+		impl_continuation &k = top();
+		if (k.cursor >= 0) {
+			evaluate(nodes[nodes[k.cursor].first].next);
+			return;
+		}
+
+		const node &n = nodes[k.index];
+		int bindings = nodes[n.first].next;
+		if (n.form == builtin::let) {
+			int j = k.base;
+			for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next)
+				local(nodes[nodes[i].first]) = stack[j++];
+
+			stack.size = k.base;
+		}
+
+		if (n.form == builtin::loop)
+			k.step = impl_step::loop;
+		else
+			control.size--;
+
+		sequence(nodes[bindings].next);
+	}
+
+	constexpr void bound() {
+		impl_continuation &k = top();
+		const node &symbol = nodes[nodes[k.cursor].first];
+		if (nodes[k.index].form == builtin::let)
+			stack.push(result);
+		else
+			local(symbol) = result;
+
+		k.cursor = nodes[k.cursor].next;
+		bind();
+	}
+
+	// (recur expressions...) rebinds the symbols of the enclosing (loop ...)
+	// and restarts its body; only allowed in tail position
+	constexpr void recur(int index, int base) {
+		if (control.size == 0 || top().step != impl_step::loop) {
+			fail(error_code::syntax, index);
+			return;
+		}
+
+		int bindings = nodes[nodes[top().index].first].next;
+		if (stack.size - base != nodes[bindings].size) {
+			fail(error_code::arity, index);
+			return;
+		}
+
+		int j = base;
+		for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next)
+			local(nodes[nodes[i].first]) = stack[j++];
+
+		stack.size = base;
+		sequence(nodes[bindings].next);
+	}
+
+	// (do ((symbol init [step])...) (test result...) body...); without
+	// result expressions the result is #f
+	constexpr void iterate(int index) {
+		const node &n = nodes[index];
+		if (n.size < 3) {
+			fail(error_code::arity, index);
+			return;
+		}
+
+		int bindings = nodes[n.first].next;
+		int test = nodes[bindings].next;
+		if (!impl_bindings(nodes, bindings, 3) || nodes[test].kind != node_kind::list || nodes[test].size == 0) {
+			fail(error_code::syntax, index);
+			return;
+		}
+
+		push(impl_step::iterate, index, nodes[bindings].first);
+		step();
+	}
+
+	// Continues the (do ...) on top from its stage and cursor
+	constexpr void step() {
+		impl_continuation &k = top();
+		int bindings = nodes[nodes[k.index].first].next;
+		int test = nodes[bindings].next;
+
+		// Direct tests are settled at once, so iterations without a body
+		// stay in this loop
+		for (;;) {
+			if (k.phase == impl_do_body) {
+				if (k.cursor >= 0) {
+					evaluate(k.cursor);
+					return;
+				}
+
+				k.phase = impl_do_step;
+				k.cursor = nodes[bindings].first;
+			}
+
+			// Initial values and steps are all evaluated before being
+			// stored; symbols without a step keep their value
+			for (; k.cursor >= 0; k.cursor = nodes[k.cursor].next) {
+				const node &b = nodes[k.cursor];
+				int expression = nodes[b.first].next;
+				if (k.phase == impl_do_step)
+					expression = nodes[expression].next;
+
+				if (expression >= 0 && nodes[expression].kind == node_kind::list && !nodes[expression].direct) {
+					evaluate(expression);
+					return;
+				}
+
+				stack.push((expression >= 0) ? settle(expression) : local(nodes[b.first]));
+				if (failed())
+					return;
+			}
+
+			int j = k.base;
+			for (int i = nodes[bindings].first; i >= 0; i = nodes[i].next)
+				local(nodes[nodes[i].first]) = stack[j++];
+
+			stack.size = k.base;
+			k.phase = impl_do_test;
+
+			int condition = nodes[test].first;
+			if (nodes[condition].kind == node_kind::list && !nodes[condition].direct) {
+				evaluate(condition);
+				return;
+			}
+
+			give(settle(condition));
+			if (failed())
+				return;
+
+			if (impl_truthy(result)) {
+				conclude(test);
+				return;
+			}
+
+			k.phase = impl_do_body;
+			k.cursor = nodes[test].next;
+		}
+	}
+
+	constexpr void stepped() {
+		impl_continuation &k = top();
+		int test = nodes[nodes[nodes[k.index].first].next].next;
+
+		if (k.phase != impl_do_test) {
+			if (k.phase != impl_do_body)
+				stack.push(result);
+
+			k.cursor = nodes[k.cursor].next;
+			step();
+			return;
+		}
+
+		if (!impl_truthy(result)) {
+			k.phase = impl_do_body;
+			k.cursor = nodes[test].next;
+			step();
+			return;
+		}
+
+		conclude(test);
+	}
+
+	// Ends the (do ...) on top once its test holds
+	constexpr void conclude(int test) {
+		control.size--;
+		if (nodes[nodes[test].first].next >= 0)
+			sequence(nodes[nodes[test].first].next);
+		else
+			give({ .kind = value_kind::boolean, .integer = false });
+	}
+
+	// (quote datum); symbols are data too
+	constexpr value quote(int index) {
+		const node &n = nodes[index];
+		if (n.size != 2)
+			return fail(error_code::arity, index);
+
+		return datum(nodes[n.first].next);
+	}
+
+	constexpr value datum(int index) {
+		const node &n = nodes[index];
+		if (n.kind == node_kind::symbol)
+			return symbol(index);
+
+		if (n.kind != node_kind::list)
+			return atom(index);
+
+		// Vectors are data too, e.g. '(#(1 2) #(3 4))
+		int base = stack.size;
+		int first = (n.form == builtin::vector) ? nodes[n.first].next : n.first;
+		for (int i = first; i >= 0; i = nodes[i].next)
+			stack.push(datum(i));
+
+		return (n.form == builtin::vector) ? pack_vector(index, base) : pack(base);
+	}
+
+	// Copies the elements of the list to the end of the heap
+	constexpr void copy(const value &list) {
+		for (int i = 0; i < list.size; i++) {
+			value element = heap[list.offset + i];
+			heap.push(element);
+		}
+	}
+
+	// Lists built by cons are preceded by twice as many free slots as they
+	// have elements, so that consing onto the newest list (the usual way to
+	// build one) takes constant time, with few copies
+	constexpr value cons(const value &x, const value &list) {
+		if (list.offset > 0 && impl_free(heap[list.offset - 1])) {
+			heap[list.offset - 1] = x;
+			return { .kind = value_kind::list, .offset = list.offset - 1, .size = list.size + 1 };
+		}
+
+		for (int i = 0; i <= 2 * list.size; i++)
+			heap.push(impl_free_slot);
+
+		value result { .kind = value_kind::list, .offset = heap.push(x), .size = list.size + 1 };
+		copy(list);
+		return result;
+	}
+
+	// List primitives, with their operands on the stack from base
+	constexpr value primitive(int index, int base) {
+		const node &n = nodes[index];
+		int count = stack.size - base;
+		if (count == 0)
+			return (n.form == builtin::append) ? value { .kind = value_kind::list } : fail(error_code::arity, index);
+
+		const value *args = &stack[base];
+		int arity = (n.form == builtin::cons || n.form == builtin::nth) ? 2 : 1;
+		if (n.form != builtin::append && count != arity)
+			return fail(error_code::arity, index);
+
+		// The list is the last operand, except for append; length also takes
+		// vectors and strings
+		for (int i = (n.form == builtin::append) ? 0 : count - 1; i < count; i++) {
+			bool sized = (args[i].kind == value_kind::vector || args[i].kind == value_kind::string);
+			if (args[i].kind != value_kind::list && !(n.form == builtin::length && sized))
+				return fail(error_code::type, index);
+		}
+
+		const value &list = args[count - 1];
+		value result { .kind = value_kind::list, .offset = heap.size };
+		switch (n.form) {
+		case builtin::cons:
+			result = cons(args[0], list);
+			break;
+		case builtin::car:
+			if (list.size == 0)
+				return fail(error_code::type, index);
+
+			result = heap[list.offset];
+			break;
+		case builtin::cdr:
+			if (list.size == 0)
+				return fail(error_code::type, index);
+
+			result = { .kind = value_kind::list, .offset = list.offset + 1, .size = list.size - 1 };
+			break;
+		case builtin::nth:
+			if (args[0].kind != value_kind::integer || args[0].integer < 0 || args[0].integer >= list.size)
+				return fail(error_code::type, index);
+
+			result = heap[list.offset + args[0].integer];
+			break;
+		case builtin::append:
+			for (int i = 0; i < count; i++) {
+				copy(args[i]);
+				result.size += args[i].size;
+			}
+			break;
+		default:
+			result = { .kind = value_kind::integer, .integer = list.size };
+			break;
+		}
+
+		stack.size = base;
+		return result;
+	}
+
+	// Structural equality, as for value_view
+	constexpr bool equal(const value &x, const value &y) const {
+		if (x.kind != y.kind)
+			return false;
+
+		switch (x.kind) {
+		case value_kind::real:
+			return x.real == y.real;
+		case value_kind::function:
+			return x.integer == y.integer && x.offset == y.offset;
+		case value_kind::integer:
+		case value_kind::boolean:
+			return x.integer == y.integer;
+		default:
+			// The sign of bignums
+			if (x.kind == value_kind::big && x.integer != y.integer)
+				return false;
+
+			if (x.size != y.size)
+				return false;
+
+			for (int i = 0; i < x.size; i++) {
+				if (!equal(heap[x.offset + i], heap[y.offset + i]))
+					return false;
+			}
+
+			return true;
+		}
+	}
+
+	// String primitives, with their operands on the stack from base
+	constexpr value strings(int index, int base) {
+		const node &n = nodes[index];
+		const value *args = &stack[base];
+		int count = stack.size - base;
+		int arity = (n.form == builtin::equal_values) ? 2 : 1;
+		if (n.form == builtin::substr ? (count != 2 && count != 3) : (n.form != builtin::concat && count != arity))
+			return fail(error_code::arity, index);
+
+		value result {};
+		switch (n.form) {
+		case builtin::concat:
+			result = { .kind = value_kind::string, .offset = heap.size };
+			for (int i = 0; i < count; i++) {
+				if (args[i].kind != value_kind::string && args[i].kind != value_kind::symbol)
+					return fail(error_code::type, index);
+
+				copy(args[i]);
+				result.size += args[i].size;
+			}
+			break;
+		case builtin::substr: {
+			bool integers = (args[1].kind == value_kind::integer && args[count - 1].kind == value_kind::integer);
+			long int begin = args[1].integer;
+			long int end = (count == 3) ? args[2].integer : args[0].size;
+			if (args[0].kind != value_kind::string || !integers || begin < 0 || begin > end || end > args[0].size)
+				return fail(error_code::type, index);
+
+			result = { .kind = value_kind::string, .offset = args[0].offset + int(begin), .size = int(end - begin) };
+			break;
+		}
+		case builtin::equal_values:
+			result = { .kind = value_kind::boolean, .integer = equal(args[0], args[1]) };
+			break;
+		case builtin::string_to_symbol:
+		case builtin::symbol_to_string: {
+			bool to_symbol = (n.form == builtin::string_to_symbol);
+			if (args[0].kind != (to_symbol ? value_kind::string : value_kind::symbol))
+				return fail(error_code::type, index);
+
+			result = args[0];
+			result.kind = to_symbol ? value_kind::symbol : value_kind::string;
+			break;
+		}
+		default: {
+			if (args[0].kind != value_kind::integer && args[0].kind != value_kind::big)
+				return fail(error_code::type, index);
+
+			std::string digits = widen(args[0]).to_string();
+			result = text(value_kind::string, digits.data(), digits.size());
+			break;
+		}
+		}
+
+		stack.size = base;
+		return result;
+	}
+
+	// (map function list) and (reduce function initial list) call the
+	// function on every element in turn, with the function, the accumulated
+	// value (for reduce) and the list on the stack from base. Mapping over a
+	// vector makes a vector. (where table predicate) and (sum table
+	// function) are traversed like map over the rows, with the function
+	// first.
+	constexpr void traverse(int index, int base) {
+		bool map = (nodes[index].form != builtin::reduce);
+		bool table = (nodes[index].form == builtin::where || nodes[index].form == builtin::sum);
+		if (stack.size - base != (map ? 2 : 3)) {
+			fail(error_code::arity, index);
+			return;
+		}
+
+		if (table)
+			std::swap(stack[base], stack[base + 1]);
+
+		value_kind kind = stack[stack.size - 1].kind;
+		bool traversable = (kind == value_kind::list || kind == value_kind::vector);
+		if (table)
+			traversable = (rows(stack[base + 1]) >= 0);
+
+		if (stack[base].kind != value_kind::function || !traversable) {
+			fail(error_code::type, index);
+			return;
+		}
+
+		control.push({ .step = impl_step::traverse, .index = index, .cursor = 0, .base = base });
+		visit();
+	}
+
+	// (make-vector size [fill]); a function fill is traversed like map over
+	// the indices, with the function and the size on the stack from base
+	constexpr void make_vector(int index, int base) {
+		int count = stack.size - base;
+		if (count != 1 && count != 2) {
+			fail(error_code::arity, index);
+			return;
+		}
+
+		value size = stack[base];
+		value fill = (count == 2) ? stack[base + 1] : value { .kind = value_kind::real };
+		if (size.kind != value_kind::integer || size.integer < 0) {
+			fail(error_code::type, index);
+			return;
+		}
+
+		if (fill.kind != value_kind::function) {
+			stack.size = base;
+			for (long int i = 0; i < size.integer; i++)
+				stack.push(fill);
+
+			give(pack_vector(index, base));
+			return;
+		}
+
+		stack[base] = fill;
+		stack[base + 1] = size;
+		control.push({ .step = impl_step::traverse, .index = index, .cursor = 0, .base = base });
+		visit();
+	}
+
+	// Calls the function on the element at the cursor, or on the cells of the
+	// row; results other than those of reduce are gathered on the stack
+	constexpr void visit() {
+		impl_continuation &k = top();
+		builtin form = nodes[k.index].form;
+		bool indices = (form == builtin::make_vector);
+		bool filter = (form == builtin::where || form == builtin::sum);
+		bool map = (form != builtin::reduce);
+		value function = stack[k.base];
+		value accumulated = stack[k.base + 1];
+		value list = stack[k.base + 2 - map];
+
+		int count = list.size;
+		if (indices)
+			count = list.integer;
+		else if (filter)
+			count = heap[list.offset].size;
+
+		// Direct builtins are applied to every element in turn here, each
+		// application taking the step of resuming with its value
+		const node &f = nodes[function.offset];
+		bool direct = (f.kind == node_kind::symbol && impl_direct(f.form));
+
+		for (;;) {
+			if (k.cursor == count) {
+				int index = k.index;
+				int base = k.base;
+				control.size--;
+
+				if (map) {
+					value result {};
+					if (form == builtin::sum)
+						result = total(index, base + 2);
+					else if (filter)
+						result = matching(list, base + 2);
+					else if (indices || list.kind == value_kind::vector)
+						result = pack_vector(index, base + 2);
+					else
+						result = pack(base + 2);
+
+					stack.size = base;
+					give(result);
+				} else {
+					stack.size = base;
+					give(accumulated);
+				}
+
+				return;
+			}
+
+			// Folding integers needs no stack
+			value v {};
+			if (direct && !map && impl_binary(f.form, accumulated, heap[list.offset + k.cursor], v)) {
+				k.cursor++;
+				if (++steps > fuel) {
+					fail(error_code::fuel, k.index);
+					return;
+				}
+
+				accumulated = stack[k.base + 1] = v;
+				continue;
+			}
+
+			int call = stack.size;
+			if (!direct)
+				stack.push(function);
+
+			if (!map)
+				stack.push(accumulated);
+
+			if (indices) {
+				stack.push({ .kind = value_kind::integer, .integer = k.cursor });
+			} else if (filter) {
+				for (int c = 0; c < list.size; c++)
+					stack.push(cell(list, c, k.cursor));
+			} else {
+				stack.push(heap[list.offset + k.cursor]);
+			}
+
+			k.cursor++;
+			if (!direct) {
+				apply(k.index, call);
+				return;
+			}
+
+			v = immediate(function.offset, call);
+			if (failed())
+				return;
+
+			if (++steps > fuel) {
+				fail(error_code::fuel, k.index);
+				return;
+			}
+
+			if (map)
+				stack.push(v);
+			else
+				accumulated = stack[k.base + 1] = v;
+		}
+	}
+
+	// Number of rows of a table, or -1 if the value is not one
+	constexpr int rows(const value &t) const {
+		if (t.kind != value_kind::list || t.size == 0)
+			return -1;
+
+		for (int c = 0; c < t.size; c++) {
+			const value &column = heap[t.offset + c];
+			if (column.kind != value_kind::vector || column.size != heap[t.offset].size)
+				return -1;
+		}
+
+		return heap[t.offset].size;
+	}
+
+	constexpr value cell(const value &t, int column, int row) const {
+		return heap[heap[t.offset + column].offset + row];
+	}
+
+	// Table of the given rows, in order
+	constexpr value gather(const value &t, const int *selected, int count) {
+		int base = stack.size;
+		for (int c = 0; c < t.size; c++) {
+			stack.push({ .kind = value_kind::vector, .offset = heap.size, .size = count });
+			for (int r = 0; r < count; r++)
+				heap.push(cell(t, c, selected[r]));
+		}
+
+		return pack(base);
+	}
+
+	// Rows whose predicate values, on the stack from base, are true
+	constexpr value matching(const value &t, int base) {
+		impl_arena <int> selected;
+		for (int r = 0; r < stack.size - base; r++) {
+			if (impl_truthy(stack[base + r]))
+				selected.push(r);
+		}
+
+		return gather(t, selected.data, selected.size);
+	}
+
+	// Sum of the values on the stack from base, as a real
+	constexpr value total(int index, int base) {
+		value result { .kind = value_kind::real };
+		for (int i = base; i < stack.size; i++) {
+			if (!impl_numeric(stack[i]) && stack[i].kind != value_kind::big)
+				return fail(error_code::type, index);
+
+			result.real += real(stack[i]);
+		}
+
+		return result;
+	}
+
+	// Rows in ascending order of a column, stable
+	constexpr void sort(const value &t, int column, impl_arena <int> &order) const {
+		int count = rows(t);
+		for (int r = 0; r < count; r++)
+			order.push(r);
+
+		std::sort(order.data, order.data + count, [&](int x, int y) {
+			double a = cell(t, column, x).real;
+			double b = cell(t, column, y).real;
+			return a < b || (a == b && x < y);
+		});
+	}
+
+	// (select table column...), (sort-by table column), (group-by table
+	// column) and (sum table column); groups are lists of a key and the table
+	// of its rows, in ascending order of keys. (sum vector) sums the elements
+	// of a vector.
+	constexpr value query(int index, int base) {
+		const node &n = nodes[index];
+		int count = stack.size - base;
+		if (count == 0 || (n.form != builtin::select && count > 2))
+			return fail(error_code::arity, index);
+
+		value t = stack[base];
+		if (n.form == builtin::sum && count == 1) {
+			if (t.kind != value_kind::vector)
+				return fail(error_code::type, index);
+
+			double total = 0;
+			for (int i = 0; i < t.size; i++)
+				total += heap[t.offset + i].real;
+
+			stack.size = base;
+			return { .kind = value_kind::real, .real = total };
+		}
+
+		if (n.form != builtin::select && count != 2)
+			return fail(error_code::arity, index);
+
+		if (rows(t) < 0)
+			return fail(error_code::type, index);
+
+		for (int i = base + 1; i < stack.size; i++) {
+			if (stack[i].kind != value_kind::integer || stack[i].integer < 0 || stack[i].integer >= t.size)
+				return fail(error_code::type, index);
+		}
+
+		int column = (count > 1) ? stack[base + 1].integer : 0;
+		value result { .kind = value_kind::list, .offset = heap.size, .size = count - 1 };
+		switch (n.form) {
+		case builtin::select:
+			// Columns are shared
+			for (int i = base + 1; i < stack.size; i++)
+				heap.push(heap[t.offset + stack[i].integer]);
+			break;
+		case builtin::sum:
+			result = { .kind = value_kind::real };
+			for (int r = 0, height = rows(t); r < height; r++)
+				result.real += cell(t, column, r).real;
+			break;
+		default: {
+			impl_arena <int> order;
+			sort(t, column, order);
+			if (n.form == builtin::sort_by) {
+				result = gather(t, order.data, order.size);
+				break;
+			}
+
+			int groups = stack.size;
+			for (int begin = 0, end = 0; begin < order.size; begin = end) {
+				double key = cell(t, column, order[begin]).real;
+				while (end < order.size && cell(t, column, order[end]).real == key)
+					end++;
+
+				int group = stack.size;
+				stack.push({ .kind = value_kind::real, .real = key });
+				value members = gather(t, &order[begin], end - begin);
+				stack.push(members);
+
+				value pair = pack(group);
+				stack.push(pair);
+			}
+
+			result = pack(groups);
+			break;
+		}
+		}
+
+		stack.size = base;
+		return result;
+	}
+
+	// Tables from CSV text, as lists of column vectors
+	constexpr value load(const table &t) {
+		const metacpp::data::constexpr_string &csv = t.csv;
+		impl_arena <double> cells;
+		int columns = -1;
+		int count = 0;
+		bool header = true;
+
+		for (size_t line = 0; line < csv.size; line++) {
+			size_t end = line;
+			while (end < csv.size && csv.str[end] != '\n')
+				end++;
+
+			// Cells are separated by commas, with optional blanks
+			int fields = 0;
+			int first = cells.size;
+			bool numeric = true;
+			for (size_t i = line; numeric; i++) {
+				while (i < end && (csv.str[i] == ' ' || csv.str[i] == '\t' || csv.str[i] == '\r'))
+					i++;
+
+				if (i == end && fields == 0)
+					break;
+
+				auto number = metacpp::lang::match_float <double> (csv, i);
+				numeric = number.success && number.next <= end;
+				if (!numeric)
+					break;
+
+				cells.push(number.value);
+				fields++;
+
+				i = number.next;
+				while (i < end && (csv.str[i] == ' ' || csv.str[i] == '\t' || csv.str[i] == '\r'))
+					i++;
+
+				if (i == end)
+					break;
+
+				numeric = (csv.str[i] == ',');
+			}
+
+			line = end;
+			if (!numeric && header) {
+				cells.size = first;
+				header = false;
+				continue;
+			}
+
+			if (fields == 0 && numeric)
+				continue;
+
+			header = false;
+			if (!numeric || (columns >= 0 && fields != columns))
+				return fail(error_code::table, 0);
+
+			columns = fields;
+			count++;
+		}
+
+		if (columns < 0)
+			return fail(error_code::table, 0);
+
+		int base = stack.size;
+		for (int c = 0; c < columns; c++) {
+			stack.push({ .kind = value_kind::vector, .offset = heap.size, .size = count });
+			for (int r = 0; r < count; r++)
+				heap.push({ .kind = value_kind::real, .real = cells[r * columns + c] });
+		}
+
+		return pack(base);
+	}
+
+	// (vector-ref vector index)
+	constexpr value vector_ref(int index, int base) {
+		if (stack.size - base != 2)
+			return fail(error_code::arity, index);
+
+		value vector = stack[base];
+		value i = stack[base + 1];
+		if (vector.kind != value_kind::vector || i.kind != value_kind::integer || i.integer < 0 || i.integer >= vector.size)
+			return fail(error_code::type, index);
+
+		stack.size = base;
+		return heap[vector.offset + i.integer];
+	}
+
+	constexpr value lambda(int index) {
+		int parameters = impl_parameters(nodes, index);
+		if (parameters < 0)
+			return fail(error_code::syntax, index);
+
+		return { .kind = value_kind::function, .integer = capture(), .offset = index, .size = parameters };
+	}
+
+	// (function arguments...), with the function and its arguments on the
+	// stack from base. Calls in tail position replace the frame of their
+	// caller, so that they run in constant space, and are not memoized.
+	constexpr void apply(int index, int base) {
+		value function = stack[base];
+		int count = stack.size - base - 1;
+		if (function.kind != value_kind::function) {
+			fail(error_code::type, index);
+			return;
+		}
+
+		// Builtins take the arguments in place of the function, as some of
+		// them keep their state on the stack until they are done
+		if (nodes[function.offset].kind == node_kind::symbol) {
+			for (int i = 0; i < count; i++)
+				stack[base + i] = stack[base + 1 + i];
+
+			stack.size--;
+			finish(function.offset, base);
+			return;
+		}
+
+		int parameters = function.size;
+		if (count != nodes[parameters].size) {
+			fail(error_code::arity, index);
+			return;
+		}
+
+		if (const value *memoized = memo.lookup(function, &stack[base + 1], count)) {
+			stack.size = base;
+			give(*memoized);
+			return;
+		}
+
+		if (control.size > 0 && top().step == impl_step::ret) {
+			impl_continuation &k = top();
+			for (int i = 0; i <= count; i++)
+				stack[k.base + i] = stack[base + i];
+
+			base = k.base;
+			stack.size = base + 1 + count;
+			k.cursor = count;
+			k.phase = 0;
+			frames.size = frame;
+		} else {
+			control.push({
+				.step = impl_step::ret, .index = index, .cursor = count, .base = base,
+				.phase = 1, .frame = frame, .owner = owner
+			});
+		}
+
+		owner = function.offset;
+		frame = push_frame(owner, function.integer);
+		for (int i = 0; i < count; i++)
+			frames[frame + 1 + i] = stack[base + 1 + i];
+
+		sequence(nodes[parameters].next);
+	}
+
+	constexpr void ret() {
+		impl_continuation k = top();
+		control.size--;
+
+		frames.size = frame;
+		frame = k.frame;
+		owner = k.owner;
+
+		if (k.phase)
+			memo.insert(stack[k.base], &stack[k.base + 1], k.cursor, result);
+
+		stack.size = k.base;
+	}
+
+	constexpr void start(int index) {
+		const node &n = nodes[index];
+		if (n.kind != node_kind::list) {
+			give(atom(index));
+			return;
+		}
+
+		if (n.direct) {
+			give(direct(index));
+			return;
+		}
+
+		switch (n.form) {
+		case builtin::list:
+		case builtin::plus:
+		case builtin::minus:
+		case builtin::multiply:
+		case builtin::divide:
+		case builtin::power:
+		case builtin::less:
+		case builtin::equal:
+		case builtin::greater:
+		case builtin::negation:
+		case builtin::recur:
+		case builtin::cons:
+		case builtin::car:
+		case builtin::cdr:
+		case builtin::nth:
+		case builtin::append:
+		case builtin::length:
+		case builtin::map:
+		case builtin::reduce:
+		case builtin::vector:
+		case builtin::make_vector:
+		case builtin::vector_ref:
+		case builtin::concat:
+		case builtin::substr:
+		case builtin::equal_values:
+		case builtin::string_to_symbol:
+		case builtin::symbol_to_string:
+		case builtin::number_to_string:
+		case builtin::select:
+		case builtin::where:
+		case builtin::sort_by:
+		case builtin::group_by:
+		case builtin::sum:
+			operands(index, nodes[n.first].next, stack.size, false);
+			break;
+		case builtin::branch:
+			branch(index);
+			break;
+		case builtin::cond:
+			push(impl_step::cond, index, nodes[n.first].next);
+			clause();
+			break;
+		case builtin::conjunction:
+		case builtin::disjunction:
+			logical(index);
+			break;
+		case builtin::let:
+		case builtin::sequential_let:
+		case builtin::loop:
+			let(index);
+			break;
+		case builtin::iterate:
+			iterate(index);
+			break;
+		case builtin::quote:
+			give(quote(index));
+			break;
+		case builtin::lambda:
+			give(lambda(index));
+			break;
+		case builtin::defun:
+			// Only allowed at the top-level
+			fail(error_code::syntax, index);
+			break;
+		default:
+			if (n.size == 0) {
+				fail(error_code::unknown_form, index);
+				break;
+			}
+
+			// The function is evaluated as the first operand
+			operands(index, n.first, stack.size, false);
+			break;
+		}
+	}
+
+	// Passes the value to the step on top
+	constexpr void resume() {
+		impl_continuation &k = top();
+		switch (k.step) {
+		case impl_step::operands:
+			stack.push(result);
+			operands(k.index, k.cursor, k.base, true);
+			break;
+		case impl_step::sequence:
+			advance();
+			break;
+		case impl_step::branch:
+		{
+			int index = k.index;
+			control.size--;
+			choose(index);
+		}
+			break;
+		case impl_step::cond:
+			select();
+			break;
+		case impl_step::logical:
+			if (impl_truthy(result) != (nodes[k.index].form == builtin::conjunction))
+				control.size--;
+			else
+				advance();
+			break;
+		case impl_step::let:
+			bound();
+			break;
+		case impl_step::loop:
+			control.size--;
+			break;
+		case impl_step::iterate:
+			stepped();
+			break;
+		case impl_step::traverse:
+			if (nodes[k.index].form != builtin::reduce)
+				stack.push(result);
+			else
+				stack[k.base + 1] = result;
+
+			visit();
+			break;
+		case impl_step::ret:
+			ret();
+			break;
+		}
+	}
+
+	// Runs steps until the node has a value; the loop is nested so that no
+	// single one reaches -fconstexpr-loop-limit
+	constexpr value eval(int index) {
+		int bottom = control.size;
+		evaluate(index);
+		while (!failed()) {
+			for (int i = 0; i < impl_steps_per_round && !failed(); i++) {
+				if (next < 0 && control.size == bottom)
+					return result;
+
+				if (++steps > fuel)
+					fail(error_code::fuel, next >= 0 ? next : top().index);
+				else if (next >= 0)
+					start(next);
+				else
+					resume();
+			}
+		}
+
+		return {};
+	}
+
+	// The root frame
+	constexpr void enter() {
+		owner = 0;
+		frame = push_frame(0, -1);
+	}
+
+	// Either every top-level form, as a list, or only the value of the given
+	// one (counting forms other than definitions)
+	constexpr value program(int form = -1) {
+		enter();
+
+		for (size_t i = 0; i < tables.size(); i++)
+			frames[frame + 1 + i] = load(tables[i]);
+
+		int environment = heap.size;
+		for (int i = nodes[0].first; i >= 0; i = nodes[i].next) {
+			if (nodes[i].form != builtin::defun)
+				continue;
+
+			int parameters = impl_parameters(nodes, i);
+			if (parameters < 0)
+				return fail(error_code::syntax, i);
+
+			local(nodes[nodes[nodes[i].first].next]) = {
+				.kind = value_kind::function,
+				.integer = environment,
+				.offset = i,
+				.size = parameters
+			};
+		}
+
+		capture();
+
+		int base = stack.size;
+		int position = 0;
+		for (int i = nodes[0].first; i >= 0 && !failed(); i = nodes[i].next) {
+			if (nodes[i].form == builtin::defun)
+				continue;
+
+			if (form >= 0 && position++ != form)
+				continue;
+
+			long int before = steps;
+			stack.push(eval(i));
+			costs.push(steps - before);
+		}
+
+		if (form >= 0)
+			return (stack.size > base) ? stack[base] : value {};
+
+		return pack(base);
+	}
+};
+
+// Evaluates a parsed source; the result tree is laid out breadth first, so
+// that the elements of every list are contiguous and the root is at 0
+constexpr status impl_evaluate_flat(const metacpp::data::constexpr_string &str, const node *nodes,
+		impl_arena <value> &flat, long int fuel, int form = -1, std::span <const table> tables = {})
+{
+	impl_machine machine { str, nodes, tables };
+	machine.fuel = fuel;
+
+	value root = machine.program(form);
+	if (machine.failed())
+		return machine.state;
+
+	// Vectors and strings also number their elements in order
+	int reals = 0;
+	int text = 0;
+	flat.push(root);
+	for (int i = 0; i < flat.size; i++) {
+		if (!impl_composite(flat[i].kind))
+			continue;
+
+		if (flat[i].kind == value_kind::vector) {
+			flat[i].integer = reals;
+			reals += flat[i].size;
+		} else if (flat[i].kind == value_kind::string || flat[i].kind == value_kind::symbol) {
+			flat[i].integer = text;
+			text += flat[i].size + 1;
+		}
+
+		int offset = flat.size;
+		for (int j = 0; j < flat[i].size; j++)
+			flat.push(machine.heap[flat[i].offset + j]);
+
+		flat[i].offset = offset;
+	}
+
+	return { error_code::none, -1, flat.size };
+}
+
+// Elements of every vector of a flat tree, packed in order; returns their
+// number, and only counts them without an output
+constexpr int impl_pack_reals(const value *values, int size, double *out)
+{
+	int count = 0;
+	for (int i = 0; i < size; i++) {
+		if (values[i].kind != value_kind::vector)
+			continue;
+
+		for (int j = 0; out && j < values[i].size; j++)
+			out[values[i].integer + j] = values[values[i].offset + j].real;
+
+		count += values[i].size;
+	}
+
+	return count;
+}
+
+template <size_t N, size_t M>
+constexpr std::array <double, N> impl_reals(const std::array <value, M> &values)
+{
+	std::array <double, N> result {};
+	impl_pack_reals(values.data(), M, result.data());
+	return result;
+}
+
+// Same for the characters of strings and symbols, each null terminated
+constexpr int impl_pack_text(const value *values, int size, char *out)
+{
+	int count = 0;
+	for (int i = 0; i < size; i++) {
+		if (values[i].kind != value_kind::string && values[i].kind != value_kind::symbol)
+			continue;
+
+		for (int j = 0; out && j < values[i].size; j++)
+			out[values[i].integer + j] = char(values[values[i].offset + j].integer);
+
+		if (out)
+			out[values[i].integer + values[i].size] = '\0';
+
+		count += values[i].size + 1;
+	}
+
+	return count;
+}
+
+template <size_t N, size_t M>
+constexpr std::array <char, N> impl_text(const std::array <value, M> &values)
+{
+	std::array <char, N> result {};
+	impl_pack_text(values.data(), M, result.data());
+	return result;
+}
+
+// The flat tree is only written if it fits in the given capacity
+constexpr status impl_evaluate(const metacpp::data::constexpr_string &str, const node *nodes,
+		value *out, int capacity, long int fuel, int form, std::span <const table> tables)
+{
+	impl_arena <value> flat;
+	status state = impl_evaluate_flat(str, nodes, flat, fuel, form, tables);
+	if (state.error != error_code::none)
+		return state;
+
+	if (flat.size <= capacity) {
+		for (int i = 0; i < flat.size; i++)
+			out[i] = flat[i];
+	}
+
+	return { error_code::none, -1, flat.size };
+}
+
+template <size_t N>
+struct impl_evaluation {
+	status state {};
+	std::array <value, N> values {};
+};
+
+template <size_t N>
+constexpr impl_evaluation <N> impl_evaluate_values(const metacpp::data::constexpr_string &str, const node *nodes,
+		long int fuel = std::numeric_limits <long int> ::max(), int form = -1, std::span <const table> tables = {})
+{
+	impl_evaluation <N> result;
+	result.state = impl_evaluate(str, nodes, result.values.data(), N, fuel, form, tables);
+	return result;
+}
+
+// Programs are evaluated once into a buffer of this size, and a second time
+// only if their results do not fit
+constexpr size_t impl_buffer_size = 256;
+
+template <size_t N>
+constexpr std::array <value, N> impl_values(const metacpp::data::constexpr_string &str, const node *nodes,
+		const impl_evaluation <impl_buffer_size> &evaluation, int form, std::span <const table> tables)
+{
+	if constexpr (N > impl_buffer_size) {
+		return impl_evaluate_values <N> (str, nodes, std::numeric_limits <long int> ::max(), form, tables).values;
+	} else {
+		std::array <value, N> values {};
+		for (size_t i = 0; i < N; i++)
+			values[i] = evaluation.values[i];
+
+		return values;
+	}
+}
+
+// Steps taken to parse a source (one per node), and to evaluate each of its
+// top-level forms except definitions, in the order of the results (or only
+// the given one)
+template <size_t N>
+struct steps {
+	long int parse = 0;
+	std::array <long int, N> forms {};
+
+	constexpr long int total() const {
+		long int sum = parse;
+		for (long int n : forms)
+			sum += n;
+
+		return sum;
+	}
+};
+
+template <size_t N>
+constexpr steps <N> impl_count_steps(const metacpp::data::constexpr_string &str, const node *nodes, long int parse,
+		int form, std::span <const table> tables)
+{
+	impl_machine machine { str, nodes, tables };
+	machine.program(form);
+
+	steps <N> result { parse };
+	for (size_t i = 0; i < N; i++)
+		result.forms[i] = machine.costs[i];
+
+	return result;
+}
+
+// Instantiated only on failure, to name the error and its source offset
+template <error_code Error, int Offset>
+struct impl_check {
+	static_assert(Error != error_code::parse, "lisp: malformed source");
+	static_assert(Error != error_code::unknown_form, "lisp: unknown form");
+	static_assert(Error != error_code::unbound, "lisp: unbound symbol");
+	static_assert(Error != error_code::arity, "lisp: wrong number of arguments");
+	static_assert(Error != error_code::type, "lisp: invalid argument type");
+	static_assert(Error != error_code::syntax, "lisp: malformed special form");
+	static_assert(Error != error_code::divide_by_zero, "lisp: division by zero");
+	static_assert(Error != error_code::fuel, "lisp: out of fuel");
+	static_assert(Error != error_code::dynamic, "lisp: form cannot depend on runtime arguments");
+	static_assert(Error != error_code::overflow, "lisp: integer overflow");
+	static_assert(Error != error_code::table, "lisp: malformed table");
+
+	static constexpr bool value = true;
+};
+
+// Top-level forms other than definitions
+constexpr int impl_forms(const node *nodes)
+{
+	int count = 0;
+	for (int i = nodes[0].first; i >= 0; i = nodes[i].next)
+		count += (nodes[i].form != builtin::defun);
+
+	return count;
+}
+
+// Sources may select a single top-level form
+template <typename Source>
+constexpr int impl_form()
+{
+	if constexpr (requires { Source::form; })
+		return Source::form;
+	else
+		return -1;
+}
+
+// Sources may also bind tables
+template <typename Source>
+constexpr std::span <const table> impl_tables()
+{
+	if constexpr (requires { Source::tables; })
+		return Source::tables;
+	else
+		return {};
+}
+
+// Modules: programs importing others see their top-level definitions (but
+// not their other forms), as if they came first; later definitions shadow
+// earlier ones of the same name, also in the modules. Modules are parsed once
+// however many programs import them.
+template <int ... Programs>
+struct imports {};
+
+template <typename Source>
+struct impl_imports {
+	using type = imports <>;
+};
+
+template <typename Source>
+requires requires { typename Source::imports; }
+struct impl_imports <Source> {
+	using type = typename Source::imports;
+};
+
+// Parsed source, on its own
+template <typename Source>
+struct impl_syntax {
+	static constexpr const metacpp::data::constexpr_string &str = Source::value;
+	static constexpr long int fuel = Source::fuel ? Source::fuel : std::numeric_limits <long int> ::max();
+
+	static constexpr status impl_parsed = impl_parse(str, nullptr, fuel);
+	static_assert(impl_check <impl_parsed.error, impl_parsed.offset> ::value);
+
+	static constexpr std::array <node, impl_parsed.size> nodes
+		= impl_parse_nodes <impl_parsed.size> (str, impl_tables <Source> ());
+};
+
+// The nodes of a source followed by those of its modules, whose text also
+// follows its own; every node is then resolved again, in the same tree
+template <size_t N, size_t M>
+constexpr std::array <node, N> impl_link(const metacpp::data::constexpr_string &str, std::span <const table> tables,
+		std::span <const node> own, const std::array <std::span <const node>, M> &modules,
+		const std::array <int, M> &offsets)
+{
+	std::array <node, N> nodes {};
+	int size = 0;
+	for (const node &n : own)
+		nodes[size++] = n;
+
+	impl_arena <int> definitions;
+	for (size_t m = 0; m < M; m++) {
+		int base = size - 1;
+		for (size_t i = 1; i < modules[m].size(); i++) {
+			node n = modules[m][i];
+			n.begin += offsets[m];
+			n.end += offsets[m];
+			n.first += (n.first >= 0) ? base : 0;
+			n.next += (n.next >= 0) ? base : 0;
+			nodes[size++] = n;
+		}
+
+		for (int i = modules[m][0].first; i >= 0; i = modules[m][i].next) {
+			if (modules[m][i].form == builtin::defun)
+				definitions.push(base + i);
+		}
+	}
+
+	for (int i = definitions.size - 1; i >= 0; i--) {
+		nodes[definitions[i]].next = nodes[0].first;
+		nodes[0].first = definitions[i];
+		nodes[0].size++;
+	}
+
+	impl_resolver { str, nodes.data(), tables } .program();
+	impl_infer(nodes.data(), N);
+	return nodes;
+}
+
+template <typename Source, typename = typename impl_imports <Source> ::type>
+struct impl_linked : impl_syntax <Source> {};
+
+template <typename Source, int ... Modules>
+requires (sizeof...(Modules) > 0)
+struct impl_linked <Source, imports <Modules...>> {
+	// Modules are separated by newlines
+	static constexpr std::array <int, sizeof...(Modules)> impl_offsets = [] {
+		std::array <int, sizeof...(Modules)> offsets {};
+		int offset = Source::value.size;
+		int m = 0;
+		((offsets[m++] = offset + 1, offset += 1 + impl_syntax <program <Modules>> ::str.size), ...);
+		return offsets;
+	} ();
+
+	static constexpr size_t impl_size = Source::value.size + (... + (1 + impl_syntax <program <Modules>> ::str.size));
+	static constexpr std::array <char, impl_size> impl_text = [] {
+		std::array <char, impl_size> text {};
+		for (size_t i = 0; i < Source::value.size; i++)
+			text[i] = Source::value.str[i];
+
+		int m = 0;
+		auto append = [&] (const metacpp::data::constexpr_string &module) {
+			text[impl_offsets[m] - 1] = '\n';
+			for (size_t i = 0; i < module.size; i++)
+				text[impl_offsets[m] + i] = module.str[i];
+
+			m++;
+		};
+
+		(append(impl_syntax <program <Modules>> ::str), ...);
+		return text;
+	} ();
+
+	static constexpr metacpp::data::constexpr_string str { impl_text.data(), impl_size };
+
+	static constexpr size_t impl_nodes = impl_syntax <Source> ::nodes.size()
+		+ (... + (impl_syntax <program <Modules>> ::nodes.size() - 1));
+
+	static constexpr std::array <node, impl_nodes> nodes = impl_link <impl_nodes> (
+		str, impl_tables <Source> (), impl_syntax <Source> ::nodes,
+		std::array <std::span <const node>, sizeof...(Modules)> { impl_syntax <program <Modules>> ::nodes... },
+		impl_offsets
+	);
+};
+
+// Parsed and evaluated program, stored once per source
+template <typename Source>
+struct impl_program {
+	static constexpr const metacpp::data::constexpr_string &str = impl_linked <Source> ::str;
+	static constexpr long int fuel = Source::fuel ? Source::fuel : std::numeric_limits <long int> ::max();
+	static constexpr int form = impl_form <Source> ();
+	static constexpr std::span <const table> tables = impl_tables <Source> ();
+
+	static constexpr const auto &nodes = impl_linked <Source> ::nodes;
+	static_assert(form < impl_forms(nodes.data()), "lisp: no such top-level form");
+
+	// Parsing took one step per node
+	static constexpr long int impl_parse_steps = nodes.size();
+	static constexpr impl_evaluation <impl_buffer_size> impl_evaluated
+		= impl_evaluate_values <impl_buffer_size> (str, nodes.data(), fuel - impl_parse_steps, form, tables);
+	static constexpr status impl_state = impl_evaluated.state;
+	static_assert(impl_check <impl_state.error, impl_state.offset> ::value);
+
+	static constexpr std::array <value, impl_state.size> values
+		= impl_values <impl_state.size> (str, nodes.data(), impl_evaluated, form, tables);
+
+	// Elements of vectors, also as contiguous reals
+	static constexpr int impl_real_count = impl_pack_reals(values.data(), values.size(), nullptr);
+	alignas(64) static constexpr std::array <double, impl_real_count> reals
+		= impl_reals <impl_real_count> (values);
+
+	static constexpr int impl_text_count = impl_pack_text(values.data(), values.size(), nullptr);
+	static constexpr std::array <char, impl_text_count> text = impl_text <impl_text_count> (values);
+
+	// Evaluated again, only if used; a single form has a single count
+	static constexpr size_t impl_cost_count = (form >= 0) ? 1 : values[0].size;
+	static constexpr steps <impl_cost_count> costs
+		= impl_count_steps <impl_cost_count> (str, nodes.data(), impl_parse_steps, form, tables);
+};
+
+// Materializing result types
+template <typename Source, int Index, value_kind = impl_program <Source> ::values[Index].kind>
+struct impl_materialize {};
+
+template <typename Source, int Offset, typename>
+struct impl_materialize_list {};
+
+template <typename Source, int Offset, size_t ... Is>
+struct impl_materialize_list <Source, Offset, std::index_sequence <Is...>> {
+	using type = metacpp::data::generic_list <
+		typename impl_materialize <Source, Offset + Is> ::type...
+	>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::integer> {
+	using type = Int <impl_program <Source> ::values[Index].integer>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::real> {
+	using type = Float <impl_program <Source> ::values[Index].real>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::boolean> {
+	using type = Bool <bool(impl_program <Source> ::values[Index].integer)>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::function> {
+	static_assert(Index < 0, "lisp: functions cannot be materialized as types");
+};
+
+template <typename Source, int Offset, bool Negative, typename>
+struct impl_materialize_big {};
+
+template <typename Source, int Offset, bool Negative, size_t ... Is>
+struct impl_materialize_big <Source, Offset, Negative, std::index_sequence <Is...>> {
+	using type = Big <Negative, (unsigned int) impl_program <Source> ::values[Offset + Is].integer...>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::big> {
+	static constexpr value impl_value = impl_program <Source> ::values[Index];
+
+	using type = typename impl_materialize_big <
+		Source, impl_value.offset, bool(impl_value.integer),
+		std::make_index_sequence <impl_value.size>
+	> ::type;
+};
+
+template <typename Source, int Offset, typename>
+struct impl_materialize_vector {};
+
+template <typename Source, int Offset, size_t ... Is>
+struct impl_materialize_vector <Source, Offset, std::index_sequence <Is...>> {
+	using type = metacpp::data::list <double, impl_program <Source> ::values[Offset + Is].real...>;
+};
+
+// Vectors are a single type, whatever their size
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::vector> {
+	static constexpr value impl_value = impl_program <Source> ::values[Index];
+
+	using type = typename impl_materialize_vector <
+		Source, impl_value.offset,
+		std::make_index_sequence <impl_value.size>
+	> ::type;
+};
+
+template <typename Source, int Offset, size_t N>
+constexpr fixed_string <N> impl_fixed()
+{
+	fixed_string <N> result;
+	for (size_t i = 0; i < N; i++)
+		result.str[i] = char(impl_program <Source> ::values[Offset + i].integer);
+
+	return result;
+}
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::string> {
+	static constexpr value impl_value = impl_program <Source> ::values[Index];
+
+	using type = String <impl_fixed <Source, impl_value.offset, impl_value.size> ()>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::symbol> {
+	static constexpr value impl_value = impl_program <Source> ::values[Index];
+
+	using type = Symbol <impl_fixed <Source, impl_value.offset, impl_value.size> ()>;
+};
+
+template <typename Source, int Index>
+struct impl_materialize <Source, Index, value_kind::list> {
+	static constexpr value impl_value = impl_program <Source> ::values[Index];
+
+	using type = typename impl_materialize_list <
+		Source, impl_value.offset,
+		std::make_index_sequence <impl_value.size>
+	> ::type;
+};
+
+// Read-only view over an evaluated value tree, usable at runtime without
+// any per-element instantiation; the elements of vectors are also packed in
+// reals, and the characters of strings and symbols in chars
+struct value_view {
+	const value *values;
+	int index = 0;
+	const double *reals = nullptr;
+	const char *chars = nullptr;
+
+	constexpr const value &get() const {
+		return values[index];
+	}
+
+	constexpr value_kind kind() const {
+		return get().kind;
+	}
+
+	constexpr bool is_integer() const {
+		return kind() == value_kind::integer;
+	}
+
+	constexpr bool is_real() const {
+		return kind() == value_kind::real;
+	}
+
+	constexpr bool is_boolean() const {
+		return kind() == value_kind::boolean;
+	}
+
+	constexpr bool is_list() const {
+		return kind() == value_kind::list;
+	}
+
+	constexpr bool is_function() const {
+		return kind() == value_kind::function;
+	}
+
+	constexpr bool is_big() const {
+		return kind() == value_kind::big;
+	}
+
+	constexpr bool is_vector() const {
+		return kind() == value_kind::vector;
+	}
+
+	constexpr bool is_string() const {
+		return kind() == value_kind::string;
+	}
+
+	constexpr bool is_symbol() const {
+		return kind() == value_kind::symbol;
+	}
+
+	constexpr bool boolean() const {
+		return get().integer;
+	}
+
+	constexpr long int integer() const {
+		return get().integer;
+	}
+
+	// Integers, including bignums, are promoted
+	constexpr double real() const {
+		return is_big() ? big().to_double() : impl_real(get());
+	}
+
+	// Limbs of bignums, least significant first
+	constexpr int limbs() const {
+		return is_big() ? get().size : 0;
+	}
+
+	constexpr unsigned int limb(int i) const {
+		return (unsigned int) values[get().offset + i].integer;
+	}
+
+	// Any integer as a bignum
+	constexpr bignum big() const {
+		if (!is_big())
+			return integer();
+
+		bignum::limbs_type digits(limbs());
+		for (int i = 0; i < limbs(); i++)
+			digits[i] = limb(i);
+
+		return { bool(get().integer), std::move(digits) };
+	}
+
+	// Elements of lists and vectors
+	constexpr int size() const {
+		return (is_list() || is_vector()) ? get().size : 0;
+	}
+
+	constexpr value_view operator[](int i) const {
+		return { values, get().offset + i, reals, chars };
+	}
+
+	// Strings and symbols, null terminated
+	constexpr std::string_view text() const {
+		if (!is_string() && !is_symbol())
+			return {};
+
+		return { chars + get().integer, size_t(get().size) };
+	}
+
+	// Vectors as contiguous reals
+	constexpr std::span <const double> vector() const {
+		if (!is_vector())
+			return {};
+
+		return { reals + get().integer, size_t(get().size) };
+	}
+
+	struct iterator {
+		const value *values;
+		int index;
+		const double *reals;
+		const char *chars;
+
+		constexpr value_view operator*() const {
+			return { values, index, reals, chars };
+		}
+
+		constexpr iterator &operator++() {
+			index++;
+			return *this;
+		}
+
+		constexpr bool operator==(const iterator &) const = default;
+	};
+
+	constexpr iterator begin() const {
+		return { values, get().offset, reals, chars };
+	}
+
+	constexpr iterator end() const {
+		return { values, get().offset + size(), reals, chars };
+	}
+
+	// Structural equality; integers never equal reals, and functions are
+	// only equal within the same program
+	constexpr bool operator==(const value_view &other) const {
+		const value &x = get();
+		const value &y = other.get();
+		if (x.kind != y.kind)
+			return false;
+
+		switch (x.kind) {
+		case value_kind::real:
+			return x.real == y.real;
+		case value_kind::list:
+		case value_kind::vector:
+		case value_kind::string:
+		case value_kind::symbol:
+			if (x.size != y.size)
+				return false;
+
+			for (int i = 0; i < x.size; i++) {
+				if (!((*this)[i] == other[i]))
+					return false;
+			}
+
+			return true;
+		case value_kind::function:
+			return x.integer == y.integer && x.offset == y.offset;
+		case value_kind::big:
+			return big() == other.big();
+		default:
+			return x.integer == y.integer;
+		}
+	}
 };
 
-// Default function dispatcher
-template <metacpp::data::constexpr_string, int Index>
-struct impl_ftn_dispatcher {
-	static constexpr bool success = false;
-	static constexpr size_t next = Index;
+// Structural hash of a value tree, to check that results computed elsewhere
+// (e.g. by generated headers) agree with the evaluator
+constexpr unsigned long int checksum(const value_view &view, unsigned long int hash = 0xcbf29ce484222325ul)
+{
+	const value &v = view.get();
+	hash = (hash ^ (unsigned long int) v.kind) * 0x100000001b3ul;
+	switch (v.kind) {
+	case value_kind::real:
+		return (hash ^ std::bit_cast <unsigned long int> (v.real)) * 0x100000001b3ul;
+	case value_kind::list:
+	case value_kind::vector:
+		hash = (hash ^ (unsigned long int) v.size) * 0x100000001b3ul;
+		for (value_view element : view)
+			hash = checksum(element, hash);
+
+		return hash;
+	case value_kind::string:
+	case value_kind::symbol:
+		hash = (hash ^ (unsigned long int) v.size) * 0x100000001b3ul;
+		for (char c : view.text())
+			hash = (hash ^ (unsigned char) c) * 0x100000001b3ul;
+
+		return hash;
+	case value_kind::function:
+		return (hash ^ (unsigned long int) v.offset) * 0x100000001b3ul;
+	case value_kind::big:
+		hash = (hash ^ (unsigned long int) v.integer) * 0x100000001b3ul;
+		for (int i = 0; i < view.limbs(); i++)
+			hash = (hash ^ view.limb(i)) * 0x100000001b3ul;
+
+		return hash;
+	default:
+		return (hash ^ (unsigned long int) v.integer) * 0x100000001b3ul;
+	}
+}
+
+template <typename Source>
+constexpr value_view impl_view()
+{
+	using evaluated = impl_program <Source>;
+	return { evaluated::values.data(), 0, evaluated::reals.data(), evaluated::text.data() };
+}
+
+// Final evaluators; the root is the list of top-level forms. Result types are
+// only created through the eval_t aliases.
+template <metacpp::data::constexpr_string Str, long int Fuel = LISP_FUEL>
+constexpr value_view eval_v = impl_view <impl_string_source <Str, Fuel>> ();
+
+template <metacpp::data::constexpr_string Str, long int Fuel = LISP_FUEL>
+using eval_t = typename impl_materialize <impl_string_source <Str, Fuel>, 0> ::type;
+
+template <int Program>
+constexpr value_view program_eval_v = impl_view <program <Program>> ();
+
+template <int Program>
+using program_eval_t = typename impl_materialize <program <Program>, 0> ::type;
+
+// Steps taken by each form
+template <metacpp::data::constexpr_string Str, long int Fuel = LISP_FUEL>
+constexpr auto eval_steps_v = impl_program <impl_string_source <Str, Fuel>> ::costs;
+
+template <int Program>
+constexpr auto program_steps_v = impl_program <program <Program>> ::costs;
+
+// Single top-level forms of a program (counting forms other than definitions,
+// which are all visible), each evaluated on its own
+template <typename Source, int Form>
+struct impl_form_source {
+	static constexpr const metacpp::data::constexpr_string &value = Source::value;
+	static constexpr long int fuel = Source::fuel;
+	static constexpr std::span <const table> tables = impl_tables <Source> ();
+	static constexpr int form = Form;
+
+	using imports = typename impl_imports <Source> ::type;
 };
 
-// Constructor for list types
-constexpr char impl_list_cstr[] = "list";
-constexpr metacpp::data::constexpr_string impl_list_str(impl_list_cstr, sizeof(impl_list_cstr) - 1);
+template <int Program, int Form>
+constexpr value_view program_form_v = impl_view <impl_form_source <program <Program>, Form>> ();
 
-// Parse list
-template <metacpp::data::constexpr_string, int>
-struct impl_parse_list {};
+template <int Program, int Form>
+using program_form_t = typename impl_materialize <impl_form_source <program <Program>, Form>, 0> ::type;
 
-template <metacpp::data::constexpr_string Str, int Index>
-requires (impl_ftn_dispatcher <Str, Index> ::success)
-struct impl_parse_list <Str, Index> {
-	// Skip whitespace
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, impl_ftn_dispatcher <Str, Index> ::next).next;
-	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
-	using impl_current_type = typename impl_ftn_dispatcher <Str, Index> ::type;
+template <int Program, int Form>
+constexpr auto program_form_steps_v = impl_program <impl_form_source <program <Program>, Form>> ::costs;
 
-	using type = metacpp::concat_t <
-		impl_current_type,
-		typename impl_parse_list <Str, impl_next_start> ::type
-	>;
+// Forms evaluated in another translation unit, see LISP_PROGRAM_UNIT
+template <int Program, int Form>
+struct program_unit {
+	static const value_view value;
 };
 
-// Until we reach the end of the list (e.g. ')')
-template <metacpp::data::constexpr_string Str, int Index>
-requires (Str.str[Index] == ')')
-struct impl_parse_list <Str, Index> {
-	static constexpr size_t next = Index + 1;
-	using type = metacpp::data::generic_list <>;
+// Evaluating sources only known at runtime, with the same parser and evaluator
+namespace runtime {
+
+constexpr const char *message(error_code error)
+{
+	switch (error) {
+	case error_code::none: return "lisp: no error";
+	case error_code::parse: return "lisp: malformed source";
+	case error_code::unknown_form: return "lisp: unknown form";
+	case error_code::unbound: return "lisp: unbound symbol";
+	case error_code::arity: return "lisp: wrong number of arguments";
+	case error_code::type: return "lisp: invalid argument type";
+	case error_code::syntax: return "lisp: malformed special form";
+	case error_code::divide_by_zero: return "lisp: division by zero";
+	case error_code::fuel: return "lisp: out of fuel";
+	case error_code::dynamic: return "lisp: form cannot depend on runtime arguments";
+	case error_code::overflow: return "lisp: integer overflow";
+	default: return "lisp: malformed table";
+	}
+}
+
+struct result {
+	status state {};
+	std::vector <value> values;
+	std::vector <double> reals;
+	std::vector <char> text;
+
+	constexpr bool ok() const {
+		return state.error == error_code::none;
+	}
+
+	// The list of top-level results, as for eval_v
+	constexpr value_view view() const {
+		return { values.data(), 0, reals.data(), text.data() };
+	}
 };
 
-// Auto type casting
-struct auto_type {
-	struct eInt {};
-	struct eFloat {};
+// The syntax tree is a single allocation; every character starts at most two
+// nodes (a quote and its head), so the tree is parsed in one pass
+constexpr result eval(std::string_view source, std::span <const table> tables,
+		long int fuel = std::numeric_limits <long int> ::max())
+{
+	metacpp::data::constexpr_string str(source.data(), source.size());
+
+	result r;
+	std::vector <node> nodes(2 * source.size() + 1);
+	status parsed = impl_parse(str, nodes.data(), fuel);
+	if (parsed.error != error_code::none) {
+		r.state = parsed;
+		return r;
+	}
+	impl_resolver { str, nodes.data(), tables } .program();
+	impl_infer(nodes.data(), parsed.size);
+
+	impl_arena <value> flat;
+	r.state = impl_evaluate_flat(str, nodes.data(), flat, fuel - parsed.size, -1, tables);
+	if (r.ok()) {
+		r.values.assign(flat.data, flat.data + flat.size);
+		r.reals.resize(impl_pack_reals(flat.data, flat.size, nullptr));
+		impl_pack_reals(flat.data, flat.size, r.reals.data());
+		r.text.resize(impl_pack_text(flat.data, flat.size, nullptr));
+		impl_pack_text(flat.data, flat.size, r.text.data());
+	}
+
+	return r;
+}
+
+constexpr result eval(std::string_view source, long int fuel = std::numeric_limits <long int> ::max())
+{
+	return eval(source, {}, fuel);
+}
+
+}										// namespace runtime
+
+// Compiling an expression into a runtime function of named arguments. The
+// subtrees that do not depend on the arguments are folded while compiling,
+// by the evaluator; the rest is emitted as code over the argument types,
+// which the optimizer can inline.
+template <metacpp::data::constexpr_string ... Names>
+struct args {};
+
+enum class residual_kind : unsigned char {
+	constant,
+	argument,
+	operation
 };
 
-template <typename...>
-struct impl_auto_cast {
-	using type = auto_type::eInt;
+// Residual expressions; operations refer to a range of the operand table
+struct impl_residual {
+	residual_kind kind = residual_kind::constant;
+	builtin form = builtin::none;
+	value constant {};
+	int argument = 0;
+	int first = 0;
+	int count = 0;
+
+	// Source offset of operations, for errors
+	int offset = 0;
 };
 
-template <long int X, typename ... Values>
-struct impl_auto_cast <Int <X>, Values...> {
-	using type = typename impl_auto_cast <
-		metacpp::data::generic_list <Values...>
-	> ::type;
+template <size_t N>
+struct impl_partial {
+	status state {};
+	int root = 0;
+	std::array <impl_residual, N> residual {};
+	std::array <int, N> operands {};
 };
 
-template <double X, typename ... Values>
-struct impl_auto_cast <Float <X>, Values...> {
-	using type = auto_type::eFloat;
+struct impl_partial_evaluator {
+	const metacpp::data::constexpr_string &str;
+	const node *nodes;
+	const metacpp::data::constexpr_string *names;
+	int arity;
+
+	impl_residual *residual;
+	int *operands;
+	int residuals = 0;
+	int used = 0;
+	status state {};
+
+	impl_machine machine { str, nodes };
+	impl_arena <bool> dependent {};
+
+	constexpr int fail(error_code error, int index) {
+		if (state.error == error_code::none)
+			state = { error, nodes[index].begin, 0 };
+
+		return 0;
+	}
+
+	// Index of the argument named by an unbound symbol, or -1
+	constexpr int argument(const node &n) const {
+		if (n.kind != node_kind::symbol || n.slot >= 0)
+			return -1;
+
+		for (int i = 0; i < arity; i++) {
+			if (int(names[i].size) != n.end - n.begin)
+				continue;
+
+			bool same = true;
+			for (int j = 0; j < n.end - n.begin; j++)
+				same &= (names[i].str[j] == str.str[n.begin + j]);
+
+			if (same)
+				return i;
+		}
+
+		return -1;
+	}
+
+	constexpr int add(const impl_residual &r) {
+		residual[residuals] = r;
+		return residuals++;
+	}
+
+	// Errors of the constant evaluator are reported as they are
+	constexpr int fail(const status &error) {
+		if (state.error == error_code::none)
+			state = error;
+
+		return 0;
+	}
+
+	constexpr int constant(int index) {
+		value v = machine.eval(index);
+		if (machine.failed())
+			return fail(machine.state);
+
+		if (v.kind != value_kind::integer && v.kind != value_kind::real && v.kind != value_kind::boolean)
+			return fail(error_code::type, index);
+
+		return add({ .kind = residual_kind::constant, .constant = v });
+	}
+
+	// Operations over the given residual operands
+	constexpr int operation(int index, const impl_arena <int> &children) {
+		for (int i = 0; i < children.size; i++)
+			operands[used + i] = children[i];
+
+		used += children.size;
+		return add({
+			.kind = residual_kind::operation, .form = nodes[index].form,
+			.first = used - children.size, .count = children.size,
+			.offset = nodes[index].begin
+		});
+	}
+
+	constexpr int emit(int index) {
+		const node &n = nodes[index];
+		if (!dependent[index])
+			return constant(index);
+
+		if (n.kind == node_kind::symbol)
+			return add({ .kind = residual_kind::argument, .argument = argument(n) });
+
+		int count = n.size - 1;
+		switch (n.form) {
+		case builtin::plus:
+		case builtin::multiply:
+		case builtin::conjunction:
+		case builtin::disjunction:
+			if (count < 1)
+				return fail(error_code::arity, index);
+			break;
+		case builtin::minus:
+		case builtin::divide:
+			if (count != 2)
+				return fail(error_code::arity, index);
+			break;
+		case builtin::less:
+		case builtin::equal:
+		case builtin::greater:
+			if (count < 2)
+				return fail(error_code::arity, index);
+			break;
+		case builtin::negation:
+			if (count != 1)
+				return fail(error_code::arity, index);
+			break;
+		case builtin::branch:
+			return branch(index);
+		default:
+			return fail(error_code::dynamic, index);
+		}
+
+		impl_arena <int> children;
+		for (int i = nodes[n.first].next; i >= 0; i = nodes[i].next)
+			children.push(emit(i));
+
+		return operation(index, children);
+	}
+
+	// Constant tests select their branch
+	constexpr int branch(int index) {
+		const node &n = nodes[index];
+		if (n.size != 3 && n.size != 4)
+			return fail(error_code::arity, index);
+
+		int test = nodes[n.first].next;
+		int then = nodes[test].next;
+		int otherwise = nodes[then].next;
+		if (!dependent[test]) {
+			value condition = machine.eval(test);
+			if (machine.failed())
+				return fail(machine.state);
+
+			if (impl_truthy(condition))
+				return emit(then);
+
+			if (otherwise >= 0)
+				return emit(otherwise);
+
+			return add({ .kind = residual_kind::constant, .constant = { .kind = value_kind::boolean } });
+		}
+
+		impl_arena <int> children;
+		children.push(emit(test));
+		children.push(emit(then));
+		if (otherwise >= 0)
+			children.push(emit(otherwise));
+		else
+			children.push(add({ .kind = residual_kind::constant, .constant = { .kind = value_kind::boolean } }));
+
+		return operation(index, children);
+	}
+
+	constexpr int compile(int size) {
+		if (nodes[0].size != 1)
+			return fail(error_code::syntax, 0);
+
+		// Children follow their parent, and quoted data is constant
+		dependent.resize(size);
+		for (int i = size - 1; i >= 0; i--) {
+			const node &n = nodes[i];
+			bool d = (argument(n) >= 0);
+			if (n.kind == node_kind::list && n.form != builtin::quote) {
+				for (int j = n.first; j >= 0; j = nodes[j].next)
+					d |= dependent[j];
+			}
+
+			dependent[i] = d;
+		}
+
+		machine.enter();
+		return emit(nodes[0].first);
+	}
 };
 
-// Arithmetic operations
-enum class op_type {
-	plus,
-	minus,
-	multiply,
-	divide
+template <size_t N>
+constexpr impl_partial <N> impl_partial_evaluate(const metacpp::data::constexpr_string &str, const node *nodes,
+		const metacpp::data::constexpr_string *names, int arity)
+{
+	impl_partial <N> result;
+	impl_partial_evaluator evaluator {
+		str, nodes, names, arity,
+		result.residual.data(), result.operands.data()
+	};
+
+	result.root = evaluator.compile(N);
+	result.state = evaluator.state;
+	return result;
+}
+
+template <metacpp::data::constexpr_string Str, typename>
+struct impl_compiled {};
+
+template <metacpp::data::constexpr_string Str, metacpp::data::constexpr_string ... Names>
+struct impl_compiled <Str, args <Names...>> {
+	static constexpr const metacpp::data::constexpr_string &str = impl_string_source <Str, 0> ::value;
+	static constexpr int arity = sizeof...(Names);
+	static constexpr std::array <metacpp::data::constexpr_string, arity> names { Names... };
+
+	static constexpr status impl_parsed = impl_parse(str, nullptr);
+	static_assert(impl_check <impl_parsed.error, impl_parsed.offset> ::value);
+
+	static constexpr std::array <node, impl_parsed.size> nodes = impl_parse_nodes <impl_parsed.size> (str);
+
+	static constexpr impl_partial <impl_parsed.size> partial
+		= impl_partial_evaluate <impl_parsed.size> (str, nodes.data(), names.data(), arity);
+	static_assert(impl_check <partial.state.error, partial.state.offset> ::value);
 };
 
-template <op_type Op, typename>
-struct impl_op {};
+// Arguments are integers (long int), reals (double) or booleans
+template <typename T>
+constexpr auto impl_promote(const T &x)
+{
+	if constexpr (std::is_same_v <T, bool>)
+		return x;
+	else if constexpr (std::is_integral_v <T>)
+		return (long int) x;
+	else
+		return double(x);
+}
 
 template <typename T>
-struct impl_op <op_type::plus, T> {
-	static constexpr int impl_value = 0;
+constexpr bool impl_truthy_code(const T &x)
+{
+	if constexpr (std::is_same_v <T, bool>)
+		return x;
+	else
+		return true;
+}
+
+// Integers are promoted like in the evaluator, except that dividing them
+// always gives a real, as the type of the result cannot depend on values
+template <builtin Form, typename T, typename ... Ts>
+constexpr auto impl_arithmetic_code(T x, Ts ... ys)
+{
+	static_assert(!std::is_same_v <T, bool> && (!std::is_same_v <Ts, bool> && ...),
+		"lisp: invalid argument type");
+
+	if constexpr (Form == builtin::plus)
+		return (x + ... + ys);
+	else if constexpr (Form == builtin::multiply)
+		return (x * ... * ys);
+	else if constexpr (Form == builtin::minus)
+		return (x - ... - ys);
+	else
+		return (double(x) / ... / double(ys));
+}
+
+template <builtin Form, typename X, typename Y, typename ... Ts>
+constexpr bool impl_compare_code(X x, Y y, Ts ... rest)
+{
+	static_assert(!std::is_same_v <X, bool> && !std::is_same_v <Y, bool>,
+		"lisp: invalid argument type");
+
+	bool result = (Form == builtin::less) ? x < y
+		: (Form == builtin::greater) ? x > y
+		: x == y;
+
+	if constexpr (sizeof...(Ts) > 0)
+		return result && impl_compare_code <Form> (y, rest...);
+	else
+		return result;
+}
+
+template <typename Compiled, int Index, residual_kind = Compiled::partial.residual[Index].kind>
+struct impl_code {};
+
+template <typename Compiled, int Index>
+struct impl_code <Compiled, Index, residual_kind::constant> {
+	static constexpr value constant = Compiled::partial.residual[Index].constant;
+
+	template <typename ... Ts>
+	static constexpr auto run(const Ts &...) {
+		if constexpr (constant.kind == value_kind::integer)
+			return constant.integer;
+		else if constexpr (constant.kind == value_kind::real)
+			return constant.real;
+		else
+			return bool(constant.integer);
+	}
 };
 
-template <typename T>
-struct impl_op <op_type::multiply, T> {
-	static constexpr int impl_value = 1;
+template <typename Compiled, int Index>
+struct impl_code <Compiled, Index, residual_kind::argument> {
+	template <typename ... Ts>
+	static constexpr auto run(const Ts &... xs) {
+		return std::get <Compiled::partial.residual[Index].argument> (std::tie(xs...));
+	}
 };
 
-// ADDITION
+template <typename Compiled, int Index>
+struct impl_code <Compiled, Index, residual_kind::operation> {
+	static constexpr impl_residual self = Compiled::partial.residual[Index];
 
-// Addition with pure integers
-template <long int X, typename ... Ts>
-requires std::is_same <typename impl_auto_cast <Ts...> ::type, auto_type::eInt> ::value
-struct impl_op <op_type::plus, metacpp::data::generic_list <Int <X>, Ts...>> {
-	static constexpr long int impl_value = X + impl_op <
-		op_type::plus,
-		metacpp::data::generic_list <Ts...>
-	> ::impl_value;
+	template <int I>
+	using operand = impl_code <Compiled, Compiled::partial.operands[self.first + I]>;
 
-	using type = Int <impl_value>;
-};
+	// (and ...) and (or ...) yield the operand that decides them
+	template <int I, typename ... Ts>
+	static constexpr auto logical(const Ts &... xs) {
+		auto x = operand <I> ::run(xs...);
+		if constexpr (I + 1 == self.count) {
+			return x;
+		} else {
+			using R = std::common_type_t <decltype(x), decltype(logical <I + 1> (xs...))>;
+			if (impl_truthy_code(x) != (self.form == builtin::conjunction))
+				return R(x);
 
-// Otherwise, upcast to double
-template <typename T, typename ... Ts>
-struct impl_op <op_type::plus, metacpp::data::generic_list <T, Ts...>> {
-	static constexpr double impl_value = T::value + impl_op <
-		op_type::plus,
-		metacpp::data::generic_list <Ts...>
-	> ::impl_value;
+			return R(logical <I + 1> (xs...));
+		}
+	}
 
-	using type = Float <impl_value>;
-};
+	template <size_t ... Is, typename ... Ts>
+	static constexpr auto apply(std::index_sequence <Is...>, const Ts &... xs) {
+		if constexpr (self.form == builtin::less || self.form == builtin::equal || self.form == builtin::greater) {
+			return impl_compare_code <self.form> (operand <Is> ::run(xs...)...);
+		} else if constexpr (self.form == builtin::negation) {
+			return !impl_truthy_code(operand <0> ::run(xs...));
+		} else if constexpr (self.form == builtin::branch) {
+			using R = std::common_type_t <
+				decltype(operand <1> ::run(xs...)),
+				decltype(operand <2> ::run(xs...))
+			>;
 
-// MULTIPLICATION
+			if (impl_truthy_code(operand <0> ::run(xs...)))
+				return R(operand <1> ::run(xs...));
 
-// Multiplication with pure integers
-template <long int X, typename ... Ts>
-// TODO: avoid the nesting...						over here!
-requires std::is_same <typename impl_auto_cast <Ts...> ::type, auto_type::eInt> ::value
-struct impl_op <op_type::multiply, metacpp::data::generic_list <Int <X>, Ts...>> {
-	static constexpr long int impl_value = X * impl_op <
-		op_type::multiply,
-		metacpp::data::generic_list <Ts...>
-	> ::impl_value;
+			return R(operand <2> ::run(xs...));
+		} else if constexpr (self.form == builtin::conjunction || self.form == builtin::disjunction) {
+			return logical <0> (xs...);
+		} else {
+			return impl_arithmetic_code <self.form> (operand <Is> ::run(xs...)...);
+		}
+	}
 
-	using type = Int <impl_value>;
+	template <typename ... Ts>
+	static constexpr auto run(const Ts &... xs) {
+		return apply(std::make_index_sequence <self.count> {}, xs...);
+	}
 };
 
-// Otherwise, upcast to double
-template <typename T, typename ... Ts>
-struct impl_op <op_type::multiply, metacpp::data::generic_list <T, Ts...>> {
-	static constexpr double impl_value = T::value * impl_op <
-		op_type::multiply,
-		metacpp::data::generic_list <Ts...>
-	> ::impl_value;
+// Function object for the expression, e.g.
+//	lisp::compile <formula, lisp::args <x, y>> f;
+//	double z = f(1, 2.5);
+template <metacpp::data::constexpr_string Str, typename Args>
+struct compile {
+	using impl_type = impl_compiled <Str, Args>;
 
-	static_assert(impl_value != 0);
-	using type = Float <impl_value>;
+	template <typename ... Ts>
+	requires (sizeof...(Ts) == impl_type::arity)
+	constexpr auto operator()(const Ts &... xs) const {
+		return impl_code <impl_type, impl_type::partial.root> ::run(impl_promote(xs)...);
+	}
 };
 
-// SUBTRACTION
+// Applying an expression elementwise: the inputs are spans or scalars, which
+// are broadcast, and the whole expression is evaluated in a single loop with
+// no temporary arrays
+template <typename T>
+constexpr auto impl_input(const T &x)
+{
+	if constexpr (std::is_arithmetic_v <T>)
+		return x;
+	else
+		return std::span <const double> (x);
+}
 
-// Subtraction with pure integers
-template <long int X, long int Y>
-struct impl_op <op_type::minus, metacpp::data::generic_list <Int <X>, Int <Y>>> {
-	static constexpr long int impl_value = X - Y;
-	using type = Int <impl_value>;
-};
+template <typename T>
+constexpr auto impl_element(const T &x, size_t)
+{
+	return impl_promote(x);
+}
 
-// Otherwise, upcast to double
-template <typename X, typename Y>
-struct impl_op <op_type::minus, metacpp::data::generic_list <X, Y>> {
-	static constexpr double impl_value = double(X::value) - double(Y::value);
-	using type = Float <impl_value>;
-};
+constexpr double impl_element(std::span <const double> x, size_t i)
+{
+	return x[i];
+}
+
+// Expressions of numbers, arithmetic and if over a single comparison have
+// an explicit SIMD path
+template <size_t N>
+constexpr bool impl_vectorizable(const impl_partial <N> &partial, int index)
+{
+	const impl_residual &r = partial.residual[index];
+	if (r.kind == residual_kind::argument)
+		return true;
+
+	if (r.kind == residual_kind::constant)
+		return r.constant.kind != value_kind::boolean;
+
+	const int *operands = partial.operands.data() + r.first;
+	switch (r.form) {
+	case builtin::plus:
+	case builtin::minus:
+	case builtin::multiply:
+	case builtin::divide:
+		for (int i = 0; i < r.count; i++) {
+			if (!impl_vectorizable(partial, operands[i]))
+				return false;
+		}
+
+		return true;
+	case builtin::branch: {
+		const impl_residual &test = partial.residual[operands[0]];
+		if (test.kind != residual_kind::operation || test.count != 2)
+			return false;
+
+		if (test.form != builtin::less && test.form != builtin::equal && test.form != builtin::greater)
+			return false;
 
-// DIVISION
+		const int *compared = partial.operands.data() + test.first;
+		return impl_vectorizable(partial, compared[0]) && impl_vectorizable(partial, compared[1])
+			&& impl_vectorizable(partial, operands[1]) && impl_vectorizable(partial, operands[2]);
+	}
+	default:
+		return false;
+	}
+}
+
+#ifdef __AVX2__
 
-// Integer result only when perfectly divisible
-template <long int X, long int Y>
-requires (X % Y == 0)
-struct impl_op <op_type::divide, metacpp::data::generic_list <Int <X>, Int <Y>>> {
-	static constexpr long int impl_value = X / Y;
-	using type = Int <impl_value>;
+template <typename Compiled, int Index, residual_kind = Compiled::partial.residual[Index].kind>
+struct impl_simd_code {};
+
+template <typename Compiled, int Index>
+struct impl_simd_code <Compiled, Index, residual_kind::constant> {
+	static constexpr double constant = impl_real(Compiled::partial.residual[Index].constant);
+
+	template <typename ... Ts>
+	static __m256d run(const Ts &...) {
+		return _mm256_set1_pd(constant);
+	}
 };
 
-// Otherwise, upcast to double
-template <typename X, typename Y>
-struct impl_op <op_type::divide, metacpp::data::generic_list <X, Y>> {
-	static constexpr double impl_value = double(X::value)/double(Y::value);
-	using type = Float <impl_value>;
+template <typename Compiled, int Index>
+struct impl_simd_code <Compiled, Index, residual_kind::argument> {
+	template <typename ... Ts>
+	static __m256d run(const Ts &... xs) {
+		return std::get <Compiled::partial.residual[Index].argument> (std::tie(xs...));
+	}
 };
 
-// List dispatcher (starts with 'list')
-template <metacpp::data::constexpr_string Str, int Index>
-requires (metacpp::lang::match_string(Str, impl_list_str, Index).success)
-struct impl_ftn_dispatcher <Str, Index> {
-	// NOTE: successfuly matched list
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace
-		(Str, metacpp::lang::match_string(Str, impl_list_str, Index).next).next;
+template <typename Compiled, int Index>
+struct impl_simd_code <Compiled, Index, residual_kind::operation> {
+	static constexpr impl_residual self = Compiled::partial.residual[Index];
 
-	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
-	using type = typename impl_parse_list <Str, impl_next_start> ::type;
+	template <int I>
+	using operand = impl_simd_code <Compiled, Compiled::partial.operands[self.first + I]>;
 
-	static constexpr bool success = true;
-};
+	template <int I, typename ... Ts>
+	static __m256d fold(__m256d x, const Ts &... xs) {
+		if constexpr (I == self.count) {
+			return x;
+		} else {
+			__m256d y = operand <I> ::run(xs...);
+			if constexpr (self.form == builtin::plus)
+				x = _mm256_add_pd(x, y);
+			else if constexpr (self.form == builtin::minus)
+				x = _mm256_sub_pd(x, y);
+			else if constexpr (self.form == builtin::multiply)
+				x = _mm256_mul_pd(x, y);
+			else
+				x = _mm256_div_pd(x, y);
 
-// Addition dispatcher (starts with '+')
-template <metacpp::data::constexpr_string Str, int Index>
-requires (metacpp::lang::match_char(Str, '+', Index).success)
-struct impl_ftn_dispatcher <Str, Index> {
-	// NOTE: successfuly matched plus
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+			return fold <I + 1> (x, xs...);
+		}
+	}
 
-	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
-	static_assert(metacpp::size <impl_current_type> ::value > 0,
-		"Expected at least one argument to '+'"
-	);
+	template <typename ... Ts>
+	static __m256d run(const Ts &... xs) {
+		if constexpr (self.form == builtin::branch) {
+			using test = impl_simd_code <Compiled, Compiled::partial.operands[self.first]>;
+			constexpr int predicate = (test::self.form == builtin::less) ? _CMP_LT_OQ
+				: (test::self.form == builtin::greater) ? _CMP_GT_OQ
+				: _CMP_EQ_OQ;
 
-	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
-	using type = typename impl_op <op_type::plus, impl_current_type> ::type;
+			__m256d mask = _mm256_cmp_pd(
+				test::template operand <0> ::run(xs...),
+				test::template operand <1> ::run(xs...),
+				predicate
+			);
 
-	static constexpr bool success = true;
+			return _mm256_blendv_pd(operand <2> ::run(xs...), operand <1> ::run(xs...), mask);
+		} else {
+			return fold <1> (operand <0> ::run(xs...), xs...);
+		}
+	}
 };
 
-// Multiplication dispatcher (starts with '*')
-template <metacpp::data::constexpr_string Str, int Index>
-requires (metacpp::lang::match_char(Str, '*', Index).success)
-struct impl_ftn_dispatcher <Str, Index> {
-	// NOTE: successfuly matched plus
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+inline __m256d impl_lanes(double x, size_t)
+{
+	return _mm256_set1_pd(x);
+}
 
-	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
-	static_assert(metacpp::size <impl_current_type> ::value > 0,
-		"Expected at least one argument to '*'"
-	);
+inline __m256d impl_lanes(std::span <const double> x, size_t i)
+{
+	return _mm256_loadu_pd(x.data() + i);
+}
 
-	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
-	using type = typename impl_op <op_type::multiply, impl_current_type> ::type;
+#endif
 
-	static constexpr bool success = true;
-};
+// Function object writing the expression over the inputs to out, e.g.
+//	lisp::kernel <axpy, lisp::args <a, x, y>> f;
+//	f(out, 2.0, xs, ys);
+// Input spans must be at least as long as out.
+template <metacpp::data::constexpr_string Str, typename Args>
+struct kernel {
+	using impl_type = impl_compiled <Str, Args>;
 
-// Subtraction dispatcher (starts with '-')
-template <metacpp::data::constexpr_string Str, int Index>
-requires (metacpp::lang::match_char(Str, '-', Index).success)
-struct impl_ftn_dispatcher <Str, Index> {
-	// NOTE: successfuly matched plus
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+	static constexpr bool vectorizable = impl_vectorizable(impl_type::partial, impl_type::partial.root);
 
-	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
-	static_assert(metacpp::size <impl_current_type> ::value == 2,
-		"Expected two arguments to '-'"
-	);
+	template <typename ... Ts>
+	static constexpr void impl_loop(std::span <double> out, size_t i, const Ts &... xs) {
+		using code = impl_code <impl_type, impl_type::partial.root>;
+		for (; i < out.size(); i++)
+			out[i] = double(code::run(impl_element(xs, i)...));
+	}
 
-	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
-	using type = typename impl_op <op_type::minus, impl_current_type> ::type;
+	template <typename ... Ts>
+	requires (sizeof...(Ts) == impl_type::arity)
+	constexpr void operator()(std::span <double> out, const Ts &... xs) const {
+		size_t i = 0;
 
-	static constexpr bool success = true;
+#ifdef __AVX2__
+		if constexpr (vectorizable) {
+			if (!std::is_constant_evaluated()) {
+				using code = impl_simd_code <impl_type, impl_type::partial.root>;
+				for (; i + 4 <= out.size(); i += 4)
+					_mm256_storeu_pd(out.data() + i, code::run(impl_lanes(impl_input(xs), i)...));
+			}
+		}
+#endif
+
+		impl_loop(out, i, impl_input(xs)...);
+	}
 };
 
-// Division dispatcher (starts with '/')
-template <metacpp::data::constexpr_string Str, int Index>
-requires (metacpp::lang::match_char(Str, '/', Index).success)
-struct impl_ftn_dispatcher <Str, Index> {
-	// NOTE: successfuly matched plus
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+// Running kernels over large spans on several threads. Spans are split into
+// fixed chunks that the threads claim in order, so that the partial results
+// of reductions are the same, and combined in the same order, whatever the
+// number of threads and the schedule.
+struct executor {
+	size_t threads = std::max(1u, std::thread::hardware_concurrency());
 
-	using impl_current_type = typename impl_parse_list <Str, impl_next_start> ::type;
-	static_assert(metacpp::size <impl_current_type> ::value == 2,
-		"Expected two arguments to '/'"
-	);
+	// Elements per chunk, and below which a span is run on the calling thread
+	size_t chunk = 1 << 15;
+	size_t threshold = 1 << 17;
+
+	template <typename T>
+	static constexpr auto impl_slice(const T &x, size_t begin, size_t size) {
+		if constexpr (std::is_arithmetic_v <T>)
+			return x;
+		else
+			return x.subspan(begin, size);
+	}
+
+	// Calls f(chunk, begin, size) once for each chunk
+	template <typename F>
+	void impl_chunks(size_t size, const F &f) const {
+		size_t count = (size + chunk - 1) / chunk;
+		size_t workers = std::min(threads, count);
+		auto run = [&](size_t c) {
+			f(c, c * chunk, std::min(chunk, size - c * chunk));
+		};
+
+		if (size < threshold || workers <= 1) {
+			for (size_t c = 0; c < count; c++)
+				run(c);
+
+			return;
+		}
+
+		std::atomic <size_t> next = 0;
+		auto work = [&] {
+			for (size_t c; (c = next.fetch_add(1, std::memory_order_relaxed)) < count; )
+				run(c);
+		};
+
+		std::vector <std::thread> pool;
+		for (size_t i = 1; i < workers; i++)
+			pool.emplace_back(work);
+
+		work();
+		for (std::thread &thread : pool)
+			thread.join();
+	}
 
-	static constexpr size_t next = impl_parse_list <Str, impl_next_start> ::next;
-	using type = typename impl_op <op_type::divide, impl_current_type> ::type;
+	template <builtin Form, typename Kernel, typename ... Ts>
+	double impl_reduce(const Kernel &kernel, size_t size, const Ts &... xs) const {
+		constexpr double identity = (Form == builtin::plus) ? 0 : 1;
+		constexpr size_t block = 256;
 
-	static constexpr bool success = true;
+		std::vector <double> partials((size + chunk - 1) / chunk, identity);
+		impl_chunks(size, [&](size_t c, size_t begin, size_t count) {
+			std::array <double, block> values;
+			double partial = identity;
+			for (size_t i = 0; i < count; i += block) {
+				size_t n = std::min(block, count - i);
+				kernel(std::span <double> (values.data(), n), impl_slice(impl_input(xs), begin + i, n)...);
+				for (size_t j = 0; j < n; j++)
+					partial = (Form == builtin::plus) ? partial + values[j] : partial * values[j];
+			}
+
+			partials[c] = partial;
+		});
+
+		double result = identity;
+		for (double partial : partials)
+			result = (Form == builtin::plus) ? result + partial : result * partial;
+
+		return result;
+	}
+
+	// Writes the kernel over the inputs to out
+	template <typename Kernel, typename ... Ts>
+	void operator()(const Kernel &kernel, std::span <double> out, const Ts &... xs) const {
+		impl_chunks(out.size(), [&](size_t, size_t begin, size_t count) {
+			kernel(out.subspan(begin, count), impl_slice(impl_input(xs), begin, count)...);
+		});
+	}
+
+	// Sum and product of the kernel over the first size elements of the inputs
+	template <typename Kernel, typename ... Ts>
+	double sum(const Kernel &kernel, size_t size, const Ts &... xs) const {
+		return impl_reduce <builtin::plus> (kernel, size, xs...);
+	}
+
+	template <typename Kernel, typename ... Ts>
+	double product(const Kernel &kernel, size_t size, const Ts &... xs) const {
+		return impl_reduce <builtin::multiply> (kernel, size, xs...);
+	}
 };
 
-// Expression dispatcher (starts with '(')
-template <metacpp::data::constexpr_string Str, int Index>
-requires (metacpp::lang::match_char(Str, '(', Index).success)
-struct impl_ftn_dispatcher <Str, Index> {
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index + 1).next;
+// Compiling an expression into bytecode for a stack machine; the residual of
+// the partial evaluator is emitted in postfix order, with jumps for if, and
+// and or. The machine runs with the evaluator's dynamic types, so unlike
+// compile, results follow the same Int/Float rules.
+enum class opcode : unsigned char {
+	constant,
+	argument,
+	arithmetic,
+	compare,
+	negation,
+	jump,
+	jump_unless,
 
-	static constexpr size_t next = impl_ftn_dispatcher <Str, impl_next_start> ::next;
-	using type = metacpp::data::generic_list <
-		typename impl_ftn_dispatcher <Str, impl_next_start> ::type
-	>;
+	// Keep the value that decides (and ...) or (or ...) and jump to the end
+	jump_unless_keep,
+	jump_if_keep,
+	ret
+};
 
-	static constexpr bool success = true;
+// Operands are the argument index, the operand count or the jump target
+struct instruction {
+	opcode op = opcode::ret;
+	builtin form = builtin::none;
+	int operand = 0;
+	int offset = 0;
+	value constant {};
 };
 
-// Read numbers
-template <metacpp::data::constexpr_string Str, int Index>
-requires (metacpp::lang::match_float <double> (Str, Index).success)
-struct impl_ftn_dispatcher <Str, Index> {
-	static constexpr auto impl_result = metacpp::lang::match_float <double> (Str, Index);
+template <size_t N>
+struct impl_bytecode {
+	std::array <instruction, N> code {};
+	int size = 0;
+
+	// Maximum depth of the operand stack
+	int depth = 0;
+};
 
-	// Skip whitespace
-	static constexpr size_t next = metacpp::lang::match_whitespace
-		(Str, impl_result.next).next;
+template <size_t N>
+struct impl_assembler {
+	const impl_partial <N> &partial;
+	impl_bytecode <2 * N + 1> &out;
+	int depth = 0;
 
-	using impl_current_type = std::conditional_t <
-		impl_result.dot,
-		Float <impl_result.value>,
-		Int <(long int)(impl_result.value)>
-	>;
+	constexpr int emit(const instruction &i) {
+		out.code[out.size] = i;
+		return out.size++;
+	}
+
+	constexpr void push(int count = 1) {
+		depth += count;
+		out.depth = std::max(out.depth, depth);
+	}
+
+	constexpr void operands(const impl_residual &r, int from) {
+		for (int i = from; i < r.count; i++)
+			assemble(partial.operands[r.first + i]);
+	}
+
+	constexpr void assemble(int index) {
+		const impl_residual &r = partial.residual[index];
+		if (r.kind == residual_kind::constant) {
+			emit({ .op = opcode::constant, .constant = r.constant });
+			push();
+			return;
+		}
+
+		if (r.kind == residual_kind::argument) {
+			emit({ .op = opcode::argument, .operand = r.argument });
+			push();
+			return;
+		}
+
+		switch (r.form) {
+		case builtin::branch: {
+			assemble(partial.operands[r.first]);
+			int otherwise = emit({ .op = opcode::jump_unless });
+			depth--;
 
-	using type = metacpp::data::generic_list <impl_current_type>;
+			assemble(partial.operands[r.first + 1]);
+			int end = emit({ .op = opcode::jump });
+			depth--;
 
-	static constexpr bool success = true;
+			out.code[otherwise].operand = out.size;
+			assemble(partial.operands[r.first + 2]);
+			out.code[end].operand = out.size;
+			return;
+		}
+		case builtin::conjunction:
+		case builtin::disjunction: {
+			opcode op = (r.form == builtin::conjunction) ? opcode::jump_unless_keep : opcode::jump_if_keep;
+
+			impl_arena <int> jumps;
+			for (int i = 0; i < r.count; i++) {
+				assemble(partial.operands[r.first + i]);
+				if (i + 1 < r.count) {
+					jumps.push(emit({ .op = op }));
+					depth--;
+				}
+			}
+
+			for (int i = 0; i < jumps.size; i++)
+				out.code[jumps[i]].operand = out.size;
+
+			return;
+		}
+		case builtin::negation:
+			assemble(partial.operands[r.first]);
+			emit({ .op = opcode::negation, .offset = r.offset });
+			return;
+		case builtin::less:
+		case builtin::equal:
+		case builtin::greater:
+			operands(r, 0);
+			emit({ .op = opcode::compare, .form = r.form, .operand = r.count, .offset = r.offset });
+			depth -= r.count - 1;
+			return;
+		default:
+			operands(r, 0);
+			emit({ .op = opcode::arithmetic, .form = r.form, .operand = r.count, .offset = r.offset });
+			depth -= r.count - 1;
+			return;
+		}
+	}
 };
 
-constexpr bool impl_is_non_whitespace(const metacpp::data::constexpr_string &str, int index)
+template <size_t N>
+constexpr impl_bytecode <2 * N + 1> impl_assemble(const impl_partial <N> &partial)
 {
-	for (int i = index; i < str.size; i++) {
-		if (str.str[i] != ' ' && str.str[i] != '\t' && str.str[i] != '\n')
-			return true;
+	impl_bytecode <2 * N + 1> result;
+	impl_assembler <N> { partial, result } .assemble(partial.root);
+	result.code[result.size++] = { .op = opcode::ret };
+	return result;
+}
+
+namespace runtime {
+
+// A single value, or the error that prevented it
+struct outcome {
+	status state {};
+	value result {};
+
+	constexpr bool ok() const {
+		return state.error == error_code::none;
 	}
+};
 
-	return false;
+// Arguments are integers, reals or booleans
+template <typename T>
+constexpr value argument(const T &x)
+{
+	if constexpr (std::is_same_v <T, value>)
+		return x;
+	else if constexpr (std::is_same_v <T, bool>)
+		return { .kind = value_kind::boolean, .integer = x };
+	else if constexpr (std::is_integral_v <T>)
+		return { .kind = value_kind::integer, .integer = (long int) x };
+	else
+		return { .kind = value_kind::real, .real = double(x) };
 }
 
-// Final dispatcher (starts at beginning of string)
-template <metacpp::data::constexpr_string, int>
-struct eval {
-	using type = metacpp::data::generic_list <>;
-};
+}										// namespace runtime
 
-template <metacpp::data::constexpr_string Str, int Index>
-requires (impl_is_non_whitespace(Str, Index))
-struct eval <Str, Index> {
-	static constexpr int impl_next_start = metacpp::lang::match_whitespace(Str, Index).next;
-	using impl_current_type = typename impl_ftn_dispatcher <Str, impl_next_start> ::type;
-	static constexpr int impl_after_current = impl_ftn_dispatcher <Str, impl_next_start> ::next;
+// Function object running the bytecode of the expression, e.g.
+//	lisp::bytecode <formula, lisp::args <x, y>> f;
+//	lisp::runtime::outcome z = f(1, 2.5);
+template <metacpp::data::constexpr_string Str, typename Args>
+struct bytecode {
+	using impl_type = impl_compiled <Str, Args>;
 
-	using type = metacpp::concat_t <
-		impl_current_type,
-		typename eval <Str, impl_after_current> ::type
-	>;
+	static constexpr auto program = impl_assemble(impl_type::partial);
 
-	// NOTE: no next, since we expect to parse the entire string
-};
+	static constexpr runtime::outcome run(const value *inputs) {
+		std::array <value, std::max(program.depth, 1)> stack;
+		int top = 0;
+
+		for (int pc = 0; ; ) {
+			const instruction &i = program.code[pc++];
+			switch (i.op) {
+			case opcode::constant:
+				stack[top++] = i.constant;
+				break;
+			case opcode::argument:
+				stack[top++] = inputs[i.operand];
+				break;
+			case opcode::arithmetic: {
+				top -= i.operand;
+				const value *args = &stack[top];
+
+				node_type type = node_type::integer;
+				for (int k = 0; k < i.operand; k++) {
+					if (!impl_numeric(args[k]))
+						return { { error_code::type, i.offset, 0 } };
+
+					if (args[k].kind == value_kind::real)
+						type = node_type::real;
+				}
+
+				if (i.form == builtin::divide && impl_zero(args[1]))
+					return { { error_code::divide_by_zero, i.offset, 0 } };
+
+				// Without a heap, there are no bignums
+				if (!impl_fold(i.form, args, i.operand, type, stack[top]))
+					return { { error_code::overflow, i.offset, 0 } };
+
+				top++;
+				break;
+			}
+			case opcode::compare: {
+				top -= i.operand;
+				bool result = true;
+				for (int k = top; k < top + i.operand; k++) {
+					if (!impl_numeric(stack[k]))
+						return { { error_code::type, i.offset, 0 } };
+
+					if (k > top)
+						result &= impl_ordered(i.form, stack[k - 1], stack[k]);
+				}
+
+				stack[top++] = { .kind = value_kind::boolean, .integer = result };
+				break;
+			}
+			case opcode::negation:
+				stack[top - 1] = { .kind = value_kind::boolean, .integer = !impl_truthy(stack[top - 1]) };
+				break;
+			case opcode::jump:
+				pc = i.operand;
+				break;
+			case opcode::jump_unless:
+				if (!impl_truthy(stack[--top]))
+					pc = i.operand;
+				break;
+			case opcode::jump_unless_keep:
+				if (!impl_truthy(stack[top - 1]))
+					pc = i.operand;
+				else
+					top--;
+				break;
+			case opcode::jump_if_keep:
+				if (impl_truthy(stack[top - 1]))
+					pc = i.operand;
+				else
+					top--;
+				break;
+			case opcode::ret:
+				return { {}, stack[0] };
+			}
+		}
+	}
 
-template <metacpp::data::constexpr_string Str, int Index = 0>
-using eval_t = typename eval <Str, Index> ::type;
+	template <typename ... Ts>
+	requires (sizeof...(Ts) == impl_type::arity)
+	constexpr runtime::outcome operator()(const Ts &... xs) const {
+		const value inputs[] { runtime::argument(xs)..., value {} };
+		return run(inputs);
+	}
+};
 
 }										// namespace lisp
 
@@ -359,4 +5262,75 @@ struct impl_printf <lisp::Float <X>> {
 	}
 };
 
+// Printing booleans
+template <bool X>
+struct impl_printf <lisp::Bool <X>> {
+	static std::string value() {
+		return X ? "#t" : "#f";
+	}
+};
+
+// Printing bignums in decimal
+template <bool Negative, unsigned int ... Limbs>
+struct impl_printf <lisp::Big <Negative, Limbs...>> {
+	static std::string value() {
+		return lisp::bignum { Negative, { Limbs... } } .to_string() + "I";
+	}
+};
+
+// Printing strings and symbols
+template <lisp::fixed_string S>
+struct impl_printf <lisp::String <S>> {
+	static std::string value() {
+		return "\"" + std::string(S.view()) + "\"";
+	}
+};
+
+template <lisp::fixed_string S>
+struct impl_printf <lisp::Symbol <S>> {
+	static std::string value() {
+		return std::string(S.view());
+	}
+};
+
+// Printing value trees at runtime, in the same format
+inline std::string to_string(const lisp::value_view &view)
+{
+	if (view.is_integer())
+		return std::to_string(view.integer()) + "I";
+
+	if (view.is_big())
+		return view.big().to_string() + "I";
+
+	if (view.is_real())
+		return std::to_string(view.real()) + "F";
+
+	if (view.is_boolean())
+		return view.boolean() ? "#t" : "#f";
+
+	if (view.is_function())
+		return "#<function>";
+
+	if (view.is_string())
+		return "\"" + std::string(view.text()) + "\"";
+
+	if (view.is_symbol())
+		return std::string(view.text());
+
+	// As data::list <double, ...>
+	if (view.is_vector()) {
+		std::string result;
+		for (double x : view.vector())
+			result += (result.empty() ? "" : ", ") + std::to_string(x);
+
+		return "(" + result + ")";
+	}
+
+	std::string result;
+	for (lisp::value_view element : view)
+		result += (result.empty() ? "" : ", ") + to_string(element);
+
+	return "(" + result + ")";
+}
+
 }
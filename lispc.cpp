@@ -0,0 +1,255 @@
+#include "metacpp.hpp"
+#include "lisp.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdio.h>
+#include <string>
+
+// Evaluates a lisp source with the runtime evaluator, and writes a header with
+// its results as values and types, e.g.
+//	lispc example.lisp example.lisp.hpp
+// declares lisp::generated::example.
+
+// Identifier from the file name, without directories or extensions
+std::string identifier(const std::string &path)
+{
+	size_t begin = path.find_last_of('/');
+	begin = (begin == std::string::npos) ? 0 : begin + 1;
+
+	std::string name = path.substr(begin, path.find('.', begin) - begin);
+	for (char &c : name) {
+		if (!isalnum((unsigned char) c))
+			c = '_';
+	}
+
+	if (name.empty() || isdigit((unsigned char) name[0]))
+		name = "_" + name;
+
+	return name;
+}
+
+std::string integer_literal(long int x)
+{
+	if (x == std::numeric_limits <long int> ::min())
+		return "(-" + std::to_string(std::numeric_limits <long int> ::max()) + "l - 1)";
+
+	return std::to_string(x) + "l";
+}
+
+// Hexadecimal floats are exact
+std::string real_literal(double x)
+{
+	if (std::isinf(x))
+		return x > 0 ? "std::numeric_limits <double> ::infinity()" : "-std::numeric_limits <double> ::infinity()";
+
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), "%a", x);
+	return buffer;
+}
+
+// Octal escapes, which unlike hexadecimal ones end after three digits
+std::string string_literal(std::string_view text)
+{
+	std::string result = "\"";
+	for (char c : text) {
+		if (c == '"' || c == '\\') {
+			result += '\\';
+			result += c;
+		} else if (isprint((unsigned char) c)) {
+			result += c;
+		} else {
+			char buffer[8];
+			snprintf(buffer, sizeof(buffer), "\\%03o", (unsigned char) c);
+			result += buffer;
+		}
+	}
+
+	return result + "\"";
+}
+
+const char *kind_name(lisp::value_kind kind)
+{
+	switch (kind) {
+	case lisp::value_kind::integer: return "integer";
+	case lisp::value_kind::real: return "real";
+	case lisp::value_kind::boolean: return "boolean";
+	case lisp::value_kind::list: return "list";
+	case lisp::value_kind::function: return "function";
+	case lisp::value_kind::vector: return "vector";
+	case lisp::value_kind::string: return "string";
+	case lisp::value_kind::symbol: return "symbol";
+	default: return "big";
+	}
+}
+
+std::string value_literal(const lisp::value &v)
+{
+	std::string result = "{ .kind = lisp::value_kind::" + std::string(kind_name(v.kind));
+	if (v.integer)
+		result += ", .integer = " + integer_literal(v.integer);
+
+	if (v.real != 0 || std::signbit(v.real))
+		result += ", .real = " + real_literal(v.real);
+
+	if (v.offset)
+		result += ", .offset = " + std::to_string(v.offset);
+
+	if (v.size)
+		result += ", .size = " + std::to_string(v.size);
+
+	return result + " }";
+}
+
+// Same types as eval_t; false if there is a function, which has none
+bool type_literal(const lisp::value_view &view, std::string &out)
+{
+	const lisp::value &v = view.get();
+	switch (v.kind) {
+	case lisp::value_kind::integer:
+		out += "lisp::Int <" + integer_literal(v.integer) + ">";
+		return true;
+	case lisp::value_kind::real:
+		out += "lisp::Float <" + real_literal(v.real) + ">";
+		return true;
+	case lisp::value_kind::boolean:
+		out += v.integer ? "lisp::Bool <true>" : "lisp::Bool <false>";
+		return true;
+	case lisp::value_kind::big:
+		out += v.integer ? "lisp::Big <true" : "lisp::Big <false";
+		for (int i = 0; i < view.limbs(); i++)
+			out += ", " + std::to_string(view.limb(i)) + "u";
+
+		out += ">";
+		return true;
+	case lisp::value_kind::string:
+		out += "lisp::String <" + string_literal(view.text()) + ">";
+		return true;
+	case lisp::value_kind::symbol:
+		out += "lisp::Symbol <" + string_literal(view.text()) + ">";
+		return true;
+	case lisp::value_kind::vector:
+		out += "metacpp::data::list <double";
+		for (double x : view.vector())
+			out += ", " + real_literal(x);
+
+		out += ">";
+		return true;
+	case lisp::value_kind::list: {
+		out += "metacpp::data::generic_list <";
+		bool first = true;
+		for (lisp::value_view element : view) {
+			out += first ? "" : ", ";
+			first = false;
+			if (!type_literal(element, out))
+				return false;
+		}
+
+		out += ">";
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+// Raw string delimiter that does not occur in the source
+std::string delimiter(const std::string &source)
+{
+	std::string result = "lisp";
+	while (source.find(")" + result + "\"") != std::string::npos)
+		result += "_";
+
+	return result;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc != 3) {
+		fprintf(stderr, "usage: %s <source.lisp> <header>\n", argv[0]);
+		return 1;
+	}
+
+	std::ifstream input(argv[1]);
+	if (!input) {
+		fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+		return 1;
+	}
+
+	std::stringstream buffer;
+	buffer << input.rdbuf();
+	std::string source = buffer.str();
+
+	lisp::runtime::result result = lisp::runtime::eval(source);
+	if (!result.ok()) {
+		fprintf(stderr, "%s:%d: %s\n", argv[1], result.state.offset, lisp::runtime::message(result.state.error));
+		return 1;
+	}
+
+	std::string name = identifier(argv[1]);
+	std::string tag = delimiter(source);
+
+	std::string header;
+	header += "// Generated by lispc from " + std::string(argv[1]) + "; do not edit\n";
+	header += "#pragma once\n\n#include \"lisp.hpp\"\n\n";
+	header += "namespace lisp::generated {\n\n";
+	header += "struct " + name + " {\n";
+	header += "\tstatic constexpr char impl_cstr[] = R\"" + tag + "(" + source + ")" + tag + "\";\n";
+	header += "\tstatic constexpr metacpp::data::constexpr_string source { impl_cstr, sizeof(impl_cstr) - 1 };\n\n";
+
+	header += "\tstatic constexpr lisp::value values[] = {\n";
+	for (const lisp::value &v : result.values)
+		header += "\t\t" + value_literal(v) + ",\n";
+
+	header += "\t};\n\n";
+
+	// Elements of vectors and characters of strings, as in eval_v
+	std::string reals = "nullptr";
+	if (!result.reals.empty()) {
+		reals = "reals";
+		header += "\talignas(64) static constexpr double reals[] = {\n";
+		for (double x : result.reals)
+			header += "\t\t" + real_literal(x) + ",\n";
+
+		header += "\t};\n\n";
+	}
+
+	std::string chars = "nullptr";
+	if (!result.text.empty()) {
+		chars = "text";
+		header += "\tstatic constexpr char text[] = {\n";
+		for (size_t i = 0; i < result.text.size(); i += 16) {
+			header += "\t\t";
+			for (size_t j = i; j < result.text.size() && j < i + 16; j++)
+				header += std::to_string(int(result.text[j])) + ",";
+
+			header += "\n";
+		}
+
+		header += "\t};\n\n";
+	}
+
+	header += "\tstatic constexpr lisp::value_view view { values, 0, " + reals + ", " + chars + " };\n";
+
+
+	char checksum[32];
+	snprintf(checksum, sizeof(checksum), "0x%lxul", lisp::checksum(result.view()));
+	header += "\tstatic constexpr unsigned long int checksum = " + std::string(checksum) + ";\n";
+
+	std::string type;
+	if (type_literal(result.view(), type))
+		header += "\n\tusing type = " + type + ";\n";
+
+	header += "};\n\n}\n";
+
+	std::ofstream output(argv[2]);
+	output << header;
+	if (!output) {
+		fprintf(stderr, "%s: cannot write %s\n", argv[0], argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
@@ -2,10 +2,13 @@
 
 // Standard headers
 #include <array>
+#include <bit>
 #include <cstdint>
+#include <limits>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 
 #include <typeinfo>
 
@@ -45,18 +48,31 @@ struct constexpr_string {
 		: str(str), size(size) {}
 };
 
-// Indexing
+// Indexing; generic lists are indexed in constant depth by deriving from
+// every (index, element) pair and selecting the base with overload resolution
 template <typename, int>
 struct impl_index {};
 
-template <int Index, typename A, typename ... Values>
-struct impl_index <generic_list <A, Values...>, Index> {
-	using type = typename impl_index <generic_list <Values...>, Index - 1> ::type;
+template <size_t Index, typename T>
+struct impl_indexed {
+	using type = T;
 };
 
-template <typename A, typename ... Values>
-struct impl_index <generic_list <A, Values...>, 0> {
-	using type = A;
+template <typename, typename ...>
+struct impl_indexed_all {};
+
+template <size_t ... Is, typename ... Values>
+struct impl_indexed_all <std::index_sequence <Is...>, Values...> : impl_indexed <Is, Values>... {};
+
+template <size_t Index, typename T>
+impl_indexed <Index, T> impl_select(const impl_indexed <Index, T> &);
+
+template <int Index, typename ... Values>
+requires (Index >= 0 && Index < sizeof...(Values))
+struct impl_index <generic_list <Values...>, Index> {
+	using type = typename decltype(impl_select <Index> (
+		impl_indexed_all <std::index_sequence_for <Values...>, Values...> {}
+	)) ::type;
 };
 
 // Faster specialization for lists
@@ -118,21 +134,22 @@ struct impl_erase_front <T, list <T, x, Values...>> {
 template <typename T, typename>
 struct impl_erase_back {};
 
-template <typename T, T x>
-struct impl_erase_back <T, list <T, x>> {
-	using type = list <T>;
-	static constexpr T value = x;
-};
+// The remaining elements are read from an array, in constant depth
+template <typename T, typename, T ... Values>
+struct impl_erase_back_list {};
 
-template <typename T, T x, T ... Values>
-struct impl_erase_back <T, list <T, x, Values...>> {
-	using type = typename impl_insert_front <T,
-		typename impl_erase_back <T, list <T, Values...>> ::type, x
-	> ::type;
+template <typename T, size_t ... Is, T ... Values>
+struct impl_erase_back_list <T, std::index_sequence <Is...>, Values...> {
+	static constexpr std::array <T, sizeof...(Values)> elements {Values...};
 
-	static constexpr T value = impl_erase_back <T, list <T, Values...>> ::value;
+	using type = list <T, elements[Is]...>;
+	static constexpr T value = elements[sizeof...(Is)];
 };
 
+template <typename T, T x, T ... Values>
+struct impl_erase_back <T, list <T, x, Values...>>
+		: impl_erase_back_list <T, std::make_index_sequence <sizeof...(Values)>, x, Values...> {};
+
 // Concatenation
 template <typename, typename>
 struct impl_concat {};
@@ -268,6 +285,830 @@ constexpr T erase_back_v = erase_back <T, U> ::value;
 template <typename U, typename V>
 using concat_t = typename data::impl_concat <U, V> ::type;
 
+// Lookup tables
+namespace data {
+
+// Flat array in row-major order, with a multi-dimensional shape
+template <typename T, size_t Align, size_t ... Dims>
+requires ((Dims * ... * 1) > 0 && Align >= alignof(T) && (Align & (Align - 1)) == 0)
+struct table {
+	using value_type = T;
+
+	static constexpr size_t rank = sizeof...(Dims);
+	static constexpr size_t count = (Dims * ... * 1);
+	static constexpr std::array <size_t, rank> shape {Dims...};
+
+	alignas(Align) T elements[count];
+
+	constexpr size_t size() const {
+		return count;
+	}
+
+	constexpr const T *data() const {
+		return elements;
+	}
+
+	constexpr const T *begin() const {
+		return elements;
+	}
+
+	constexpr const T *end() const {
+		return elements + count;
+	}
+
+	constexpr const T &operator[](size_t i) const {
+		return elements[i];
+	}
+
+	template <typename ... Is>
+	requires (sizeof...(Is) == rank)
+	constexpr const T &operator()(Is ... is) const {
+		size_t offset = 0;
+		size_t d = 0;
+		((offset = offset * shape[d++] + size_t(is)), ...);
+		return elements[offset];
+	}
+};
+
+// Generators evaluate F for a flat index; over a shape, F takes one index
+// per dimension
+template <auto F, typename T, size_t ... Dims>
+struct impl_grid {
+	static constexpr std::array <size_t, sizeof...(Dims)> shape {Dims...};
+
+	template <size_t ... Is>
+	static constexpr T at(size_t flat, std::index_sequence <Is...>) {
+		std::array <size_t, sizeof...(Dims)> index {};
+		for (size_t d = sizeof...(Dims); d-- > 0; ) {
+			index[d] = flat % shape[d];
+			flat /= shape[d];
+		}
+
+		return T(F(index[Is]...));
+	}
+
+	static constexpr T at(size_t flat) {
+		return at(flat, std::make_index_sequence <sizeof...(Dims)> {});
+	}
+};
+
+// Over the elements of a list
+template <auto F, typename T, typename>
+struct impl_over {};
+
+template <auto F, typename T, typename U, U ... Values>
+struct impl_over <F, T, list <U, Values...>> {
+	static constexpr std::array <U, sizeof...(Values)> elements {Values...};
+
+	static constexpr T at(size_t flat) {
+		return T(F(elements[flat]));
+	}
+};
+
+// Entries are evaluated in chunks, each in its own constant expression, so
+// that large tables stay within -fconstexpr-ops-limit and
+// -fconstexpr-loop-limit
+constexpr size_t impl_table_chunk = 4096;
+
+template <typename G, typename T, size_t Begin, size_t Size>
+struct impl_table_part {
+	static constexpr std::array <T, Size> value = [] {
+		std::array <T, Size> out {};
+		for (size_t i = 0; i < Size; i++)
+			out[i] = G::at(Begin + i);
+
+		return out;
+	} ();
+};
+
+template <typename G, typename T, size_t Begin, size_t Size>
+constexpr void impl_copy_part(T *out)
+{
+	const auto &part = impl_table_part <G, T, Begin, Size> ::value;
+	for (size_t i = 0; i < Size; i++)
+		out[Begin + i] = part[i];
+}
+
+template <typename G, typename Table, size_t ... Cs>
+constexpr Table impl_tabulate(std::index_sequence <Cs...>)
+{
+	constexpr size_t chunk = impl_table_chunk;
+
+	Table out {};
+	(impl_copy_part <G, typename Table::value_type, Cs * chunk,
+		(Table::count - Cs * chunk < chunk) ? Table::count - Cs * chunk : chunk> (out.elements), ...);
+	return out;
+}
+
+template <typename G, typename Table>
+constexpr Table impl_tabulate()
+{
+	constexpr size_t chunks = (Table::count + impl_table_chunk - 1) / impl_table_chunk;
+	return impl_tabulate <G, Table> (std::make_index_sequence <chunks> {});
+}
+
+// Default element types
+template <auto F, size_t ... Dims>
+using impl_grid_result = std::remove_cvref_t <decltype(F(Dims...))>;
+
+template <auto F, typename>
+struct impl_over_result {};
+
+template <auto F, typename U, U ... Values>
+struct impl_over_result <F, list <U, Values...>> {
+	using type = std::remove_cvref_t <decltype(F(U {}))>;
+};
+
+// Shapes are lists of dimensions
+template <auto F, typename, typename T, size_t Align>
+struct impl_grid_table {};
+
+template <auto F, size_t ... Dims, typename T, size_t Align>
+struct impl_grid_table <F, list <size_t, Dims...>, T, Align> {
+	using element = std::conditional_t <std::is_void_v <T>, impl_grid_result <F, Dims...>, T>;
+	using type = table <element, Align ? Align : alignof(element), Dims...>;
+	using generator = impl_grid <F, element, Dims...>;
+};
+
+}
+
+// Tables of F(i, j, ...) over a shape data::list <size_t, Dims...>, evaluated
+// at compile time; the element type defaults to that of F, and the alignment
+// to that of the element type
+template <auto F, typename Shape, typename T = void, size_t Align = 0>
+inline constexpr typename data::impl_grid_table <F, Shape, T, Align> ::type make_grid
+	= data::impl_tabulate <
+		typename data::impl_grid_table <F, Shape, T, Align> ::generator,
+		typename data::impl_grid_table <F, Shape, T, Align> ::type
+	> ();
+
+// Tables of F(i) for i < N, e.g.
+//	make_table <crc, 256, uint32_t, 64>
+template <auto F, size_t N, typename T = void, size_t Align = 0>
+inline constexpr const auto &make_table = make_grid <F, data::list <size_t, N>, T, Align>;
+
+// Tables of F(x) for each element x of a list
+template <auto F, typename List, typename T = typename data::impl_over_result <F, List> ::type, size_t Align = alignof(T)>
+inline constexpr data::table <T, Align, size_v <List>> make_table_of
+	= data::impl_tabulate <data::impl_over <F, T, List>, data::table <T, Align, size_v <List>>> ();
+
+// Search layouts of sorted lists
+namespace data {
+
+// Hints that p will be read soon
+constexpr void impl_prefetch(const void *p)
+{
+	if (!std::is_constant_evaluated())
+		__builtin_prefetch(p);
+}
+
+// Elements per cache line
+template <typename T>
+constexpr size_t impl_lanes = std::bit_floor(sizeof(T) < 64 ? 64 / sizeof(T) : size_t(1));
+
+// Complete binary tree in breadth-first order, from index 1; ranks are the
+// positions in the sorted list, and ranks[0] = N for keys past the end
+template <typename T, size_t N>
+requires (N > 0 && N < (size_t(1) << 32))
+struct eytzinger {
+	alignas(64) T elements[N + 1];
+	uint32_t ranks[N + 1];
+
+	constexpr size_t size() const {
+		return N;
+	}
+
+	// Position of the first element not less than x, without branching on
+	// comparisons; the descendants four levels down share a cache line
+	// (for 4 byte elements), which is fetched ahead
+	constexpr size_t lower_bound(const T &x) const {
+		size_t k = 1;
+		while (k <= N) {
+			size_t ahead = k * impl_lanes <T>;
+			impl_prefetch(elements + (ahead <= N ? ahead : 0));
+			k = 2 * k + (elements[k] < x);
+		}
+
+		// Back up past the right turns, and the last left turn
+		k >>= std::countr_one(k) + 1;
+		return ranks[k];
+	}
+};
+
+// Static B-tree with a cache line of keys per node, also in breadth-first
+// order; node k has children k * (B + 1) + i + 1. The last node is padded
+// with the greatest key, which ranks past the end
+template <typename T, size_t N>
+requires (N > 0 && N < (size_t(1) << 32))
+struct btree {
+	static constexpr size_t lanes = impl_lanes <T>;
+	static constexpr size_t blocks = (N + lanes - 1) / lanes;
+
+	alignas(64) T keys[blocks * lanes];
+	uint32_t ranks[blocks * lanes + 1];
+
+	constexpr size_t size() const {
+		return N;
+	}
+
+	// Each node is counted in full, which vectorizes, and costs at most
+	// one cache miss per level
+	constexpr size_t lower_bound(const T &x) const {
+		size_t rank = N;
+		size_t k = 0;
+		while (k < blocks) {
+			const T *node = keys + k * lanes;
+			size_t i = 0;
+			for (size_t j = 0; j < lanes; j++)
+				i += (node[j] < x);
+
+			size_t r = ranks[k * lanes + i];
+			rank = (i < lanes) ? r : rank;
+			k = k * (lanes + 1) + i + 1;
+		}
+
+		return rank;
+	}
+};
+
+// Layouts are filled slot by slot, in the order of the arrays, as writing
+// large constexpr arrays out of order is quadratic in the compiler.
+//
+// In the perfect tree of the same height H, the node k = 2^d + j at depth d
+// has rank (2j + 1) 2^(H - d - 1) - 1; the leaves missing from the last
+// level are the rightmost ones, each ranked after the nodes left of it.
+constexpr size_t impl_eytzinger_rank(size_t k, size_t n)
+{
+	size_t height = std::bit_width(n);
+	size_t depth = std::bit_width(k) - 1;
+	size_t j = k - (size_t(1) << depth);
+	size_t leaves = n - ((size_t(1) << (height - 1)) - 1);
+
+	size_t rank = (2 * j + 1) * (size_t(1) << (height - depth - 1)) - 1;
+	size_t half = (rank + 1) / 2;
+	return rank - (half > leaves ? half - leaves : 0);
+}
+
+template <typename T, size_t N>
+constexpr void impl_fill_eytzinger(eytzinger <T, N> &out, const T *sorted)
+{
+	out.elements[0] = sorted[N - 1];
+	out.ranks[0] = N;
+	for (size_t k = 1; k <= N; k++) {
+		size_t rank = impl_eytzinger_rank(k, N);
+		out.elements[k] = sorted[rank];
+		out.ranks[k] = rank;
+	}
+}
+
+// Keys in the subtree of node k
+template <typename T, size_t N>
+constexpr size_t impl_btree_subtree(size_t k)
+{
+	constexpr size_t lanes = btree <T, N> ::lanes;
+	constexpr size_t blocks = btree <T, N> ::blocks;
+
+	size_t nodes = 0;
+	for (size_t lo = k, hi = k; lo < blocks; lo = lo * (lanes + 1) + 1, hi = hi * (lanes + 1) + lanes + 1)
+		nodes += (hi < blocks ? hi : blocks - 1) - lo + 1;
+
+	return nodes * lanes;
+}
+
+// Nodes are visited in breadth-first order, which is also that of their
+// children; each child is ranked after the keys in the subtrees of its left
+// siblings and their separating keys. Keys past the end are padding.
+template <typename T, size_t N>
+constexpr void impl_fill_btree(btree <T, N> &out, const T *sorted)
+{
+	constexpr size_t lanes = btree <T, N> ::lanes;
+	constexpr size_t blocks = btree <T, N> ::blocks;
+
+	std::array <size_t, blocks> before {};
+	for (size_t k = 0; k < blocks; k++) {
+		size_t rank = before[k];
+		for (size_t j = 0; j <= lanes; j++) {
+			size_t child = k * (lanes + 1) + j + 1;
+			if (child < blocks) {
+				before[child] = rank;
+				rank += impl_btree_subtree <T, N> (child);
+			}
+
+			if (j == lanes)
+				break;
+
+			bool real = (rank < N);
+			out.keys[k * lanes + j] = sorted[real ? rank : N - 1];
+			out.ranks[k * lanes + j] = real ? rank : N;
+			rank++;
+		}
+	}
+
+	out.ranks[blocks * lanes] = N;
+}
+
+template <typename>
+struct impl_sorted_list {};
+
+template <typename T, T ... Values>
+struct impl_sorted_list <list <T, Values...>> {
+	static constexpr std::array <T, sizeof...(Values)> elements {Values...};
+
+	// The elements are read from a local copy: each read of a large static
+	// array costs as much as copying it during constant evaluation
+	static constexpr bool sorted = [] {
+		std::array <T, sizeof...(Values)> local {Values...};
+		for (size_t i = 1; i < local.size(); i++) {
+			if (local[i] < local[i - 1])
+				return false;
+		}
+
+		return true;
+	} ();
+
+	static constexpr eytzinger <T, sizeof...(Values)> make_eytzinger() {
+		std::array <T, sizeof...(Values)> local {Values...};
+		eytzinger <T, sizeof...(Values)> out {};
+		impl_fill_eytzinger(out, local.data());
+		return out;
+	}
+
+	static constexpr btree <T, sizeof...(Values)> make_btree() {
+		std::array <T, sizeof...(Values)> local {Values...};
+		btree <T, sizeof...(Values)> out {};
+		impl_fill_btree(out, local.data());
+		return out;
+	}
+};
+
+}
+
+// Layouts of a sorted list for runtime searches; lower_bound returns the
+// position in the list, or its size
+template <typename List>
+requires data::impl_sorted_list <List> ::sorted
+inline constexpr auto make_eytzinger = data::impl_sorted_list <List> ::make_eytzinger();
+
+template <typename List>
+requires data::impl_sorted_list <List> ::sorted
+inline constexpr auto make_btree = data::impl_sorted_list <List> ::make_btree();
+
+// Range maps, from inclusive ranges of integers to values
+namespace data {
+
+template <typename T>
+struct impl_range {
+	T lo;
+	T hi;
+	T value;
+};
+
+enum class range_strategy {
+	direct,
+	paged,
+	search
+};
+
+// Offsets from the lowest key, which wrap around for keys below it
+template <typename T>
+constexpr auto impl_offset(T x, T lo)
+{
+	using U = std::make_unsigned_t <T>;
+	return uint64_t(U(U(x) - U(lo)));
+}
+
+// A value for each key in the domain, and the default past it
+template <typename T, size_t Span>
+struct range_direct {
+	static constexpr range_strategy strategy = range_strategy::direct;
+
+	T lo;
+	T values[Span + 1];
+
+	constexpr T operator()(T x) const {
+		uint64_t offset = impl_offset(x, lo);
+		return values[offset < Span ? offset : Span];
+	}
+};
+
+// Pages of 256 keys, which share blocks when they hold the same values; the
+// last page, past the domain, is the default block
+template <typename T, size_t Pages, size_t Blocks>
+struct range_paged {
+	static constexpr range_strategy strategy = range_strategy::paged;
+	static constexpr size_t page = 256;
+
+	T lo;
+	uint16_t pages[Pages + 1];
+	T blocks[Blocks][page];
+
+	constexpr T operator()(T x) const {
+		uint64_t offset = impl_offset(x, lo);
+		uint64_t p = offset / page;
+		return blocks[pages[p < Pages ? p : Pages]][offset % page];
+	}
+};
+
+// The last range starting at or before the key, by branchless binary search
+template <typename T, size_t Count>
+struct range_search {
+	static constexpr range_strategy strategy = range_strategy::search;
+
+	T fallback;
+	T lo[Count];
+	T hi[Count];
+	T values[Count];
+
+	constexpr T operator()(T x) const {
+		size_t i = 0;
+		for (size_t n = Count; n > 1; n -= n / 2)
+			i = (lo[i + n / 2] <= x) ? i + n / 2 : i;
+
+		return (lo[i] <= x && x <= hi[i]) ? values[i] : fallback;
+	}
+};
+
+template <typename T, typename>
+struct impl_range_of {
+	static_assert(
+		!std::is_same <T, T> ::value,
+		"Invalid range for range_map:"
+		" expected list <T, lo, hi, value>"
+	);
+};
+
+template <typename T, T Lo, T Hi, T Value>
+struct impl_range_of <T, list <T, Lo, Hi, Value>> {
+	static constexpr impl_range <T> value {Lo, Hi, Value};
+};
+
+// Limits of the table strategies, in entries
+constexpr uint64_t impl_direct_limit = 4096;
+constexpr uint64_t impl_paged_limit = 1 << 20;
+constexpr uint64_t impl_paged_blocks = 256;
+
+template <typename, auto>
+struct impl_range_map {};
+
+template <typename T, T Lo, T Hi, T Value, typename ... Rs, auto Default>
+struct impl_range_map <generic_list <list <T, Lo, Hi, Value>, Rs...>, Default> {
+	static_assert(std::is_integral_v <T> && !std::is_same_v <T, bool>, "range_map: keys must be integers");
+
+	static constexpr size_t n = 1 + sizeof...(Rs);
+	static constexpr T fallback = T(Default);
+
+	// Sorted by their lowest keys
+	static constexpr std::array <impl_range <T>, n> sorted = [] {
+		std::array <impl_range <T>, n> out {{{Lo, Hi, Value}, impl_range_of <T, Rs> ::value...}};
+		for (size_t i = 1; i < n; i++) {
+			for (size_t j = i; j > 0 && out[j].lo < out[j - 1].lo; j--)
+				std::swap(out[j], out[j - 1]);
+		}
+
+		return out;
+	} ();
+
+	static constexpr bool ordered = [] {
+		for (size_t i = 0; i < n; i++) {
+			if (sorted[i].hi < sorted[i].lo)
+				return false;
+		}
+
+		return true;
+	} ();
+
+	static constexpr bool disjoint = [] {
+		for (size_t i = 1; i < n; i++) {
+			if (sorted[i].lo <= sorted[i - 1].hi)
+				return false;
+		}
+
+		return true;
+	} ();
+
+	static_assert(ordered, "range_map: range with lo > hi");
+	static_assert(disjoint, "range_map: overlapping ranges");
+
+	// Adjacent ranges with the same value are merged
+	static constexpr bool adjacent(const impl_range <T> &a, const impl_range <T> &b) {
+		return a.hi < std::numeric_limits <T> ::max() && T(a.hi + 1) == b.lo && a.value == b.value;
+	}
+
+	static constexpr size_t count = [] {
+		size_t c = 1;
+		for (size_t i = 1; i < n; i++)
+			c += !adjacent(sorted[i - 1], sorted[i]);
+
+		return c;
+	} ();
+
+	static constexpr std::array <impl_range <T>, count> merged = [] {
+		std::array <impl_range <T>, count> out {};
+		size_t c = 0;
+		out[0] = sorted[0];
+		for (size_t i = 1; i < n; i++) {
+			if (adjacent(sorted[i - 1], sorted[i]))
+				out[c].hi = sorted[i].hi;
+			else
+				out[++c] = sorted[i];
+		}
+
+		return out;
+	} ();
+
+	static constexpr range_search <T, count> search = [] {
+		range_search <T, count> out {};
+		out.fallback = fallback;
+		for (size_t i = 0; i < count; i++) {
+			out.lo[i] = merged[i].lo;
+			out.hi[i] = merged[i].hi;
+			out.values[i] = merged[i].value;
+		}
+
+		return out;
+	} ();
+
+	// Shape of the domain; the span saturates, so that it compares
+	// correctly with the limits
+	static constexpr T lo = merged[0].lo;
+	static constexpr uint64_t last = impl_offset(merged[count - 1].hi, lo);
+	static constexpr uint64_t span = last < impl_paged_limit ? last + 1 : impl_paged_limit;
+
+	static constexpr T impl_key(uint64_t offset) {
+		using U = std::make_unsigned_t <T>;
+		return T(U(U(lo) + U(offset)));
+	}
+
+	static constexpr range_direct <T, span> direct() {
+		range_direct <T, span> out {};
+		out.lo = lo;
+		for (uint64_t i = 0; i < span; i++)
+			out.values[i] = search(impl_key(i));
+
+		out.values[span] = fallback;
+		return out;
+	}
+
+	// Pages without a range boundary inside hold one value, and share a
+	// block with the other such pages of that value; block 0 is the default
+	static constexpr size_t pages = (span + 255) / 256;
+
+	static constexpr std::array <bool, pages> uniform = [] {
+		std::array <bool, pages> out {};
+		out.fill(true);
+		for (const impl_range <T> &r : merged) {
+			uint64_t begin = impl_offset(r.lo, lo);
+			uint64_t end = impl_offset(r.hi, lo) + 1;
+			if (begin % 256 && begin / 256 < pages)
+				out[begin / 256] = false;
+
+			if (end % 256 && end / 256 < pages)
+				out[end / 256] = false;
+		}
+
+		return out;
+	} ();
+
+	// Returns the number of blocks, and fills out if given
+	template <size_t Blocks>
+	static constexpr size_t impl_pages(range_paged <T, pages, Blocks> *out) {
+		std::array <T, pages + 1> values {};
+		std::array <size_t, pages + 1> ids {};
+		size_t uniforms = 1;
+		values[0] = fallback;
+
+		size_t blocks = 1;
+		for (size_t p = 0; p < pages; p++) {
+			size_t block = blocks;
+			if (uniform[p]) {
+				T v = search(impl_key(p * 256));
+				size_t u = 0;
+				while (u < uniforms && values[u] != v)
+					u++;
+
+				if (u < uniforms) {
+					block = ids[u];
+				} else {
+					values[uniforms] = v;
+					ids[uniforms++] = blocks;
+				}
+			}
+
+			bool fresh = (block == blocks);
+			blocks += fresh;
+			if (fresh && out) {
+				for (size_t k = 0; k < 256; k++) {
+					uint64_t offset = p * 256 + k;
+					out->blocks[block][k] = offset < span ? search(impl_key(offset)) : fallback;
+				}
+			}
+
+			if (out)
+				out->pages[p] = block;
+		}
+
+		if (out) {
+			out->lo = lo;
+			out->pages[pages] = 0;
+			for (size_t k = 0; k < 256; k++)
+				out->blocks[0][k] = fallback;
+		}
+
+		return blocks;
+	}
+
+	static constexpr size_t blocks = impl_pages <1> (nullptr);
+
+	static constexpr range_paged <T, pages, blocks> paged() {
+		range_paged <T, pages, blocks> out {};
+		impl_pages(&out);
+		return out;
+	}
+
+	// The cheapest table that fits, or a search
+	static constexpr auto make() {
+		if constexpr (span <= impl_direct_limit)
+			return direct();
+		else if constexpr (span < impl_paged_limit && blocks <= impl_paged_blocks)
+			return paged();
+		else
+			return search;
+	}
+};
+
+}
+
+// Resolves keys to the value of the range that holds them, or to Default;
+// ranges are lists of an inclusive lower and upper key and a value, e.g.
+//	range_map <generic_list <list <int, 'a', 'z', 1>, list <int, '0', '9', 2>>>
+template <typename Ranges, auto Default = 0>
+inline constexpr auto range_map = data::impl_range_map <Ranges, Default> ::make();
+
+// Dispatching runtime values to compile-time candidates
+namespace data {
+
+template <typename>
+struct impl_candidates {};
+
+template <typename T, T x, T ... Values>
+struct impl_candidates <list <T, x, Values...>> {
+	using type = T;
+
+	template <typename F>
+	using result = decltype(std::declval <F &> ().template operator() <x> ());
+};
+
+// Multiplicative hash to the top bits; no bits means none was found
+struct impl_hash {
+	uint64_t multiplier;
+	int bits;
+
+	template <typename T>
+	constexpr size_t operator()(T x) const {
+		return (uint64_t(x) * multiplier) >> (64 - bits);
+	}
+};
+
+// Tables of thunks, each calling F for one candidate or the fallback for
+// misses; keys in a narrow span index the table directly, and others
+// through a perfect hash
+template <typename, typename F, typename G>
+struct impl_dispatch {};
+
+template <typename T, T ... Values, typename F, typename G>
+struct impl_dispatch <list <T, Values...>, F, G> {
+	static_assert(std::is_integral_v <T> && !std::is_same_v <T, bool>, "dispatch: candidates must be integers");
+
+	static constexpr size_t count = sizeof...(Values);
+	static constexpr std::array <T, count> keys {Values...};
+
+	static constexpr bool unique = [] {
+		for (size_t i = 0; i < count; i++) {
+			for (size_t j = i + 1; j < count; j++) {
+				if (keys[i] == keys[j])
+					return false;
+			}
+		}
+
+		return true;
+	} ();
+
+	static_assert(unique, "dispatch: duplicate candidates");
+
+	using result = typename impl_candidates <list <T, Values...>> ::template result <F>;
+	using thunk = result (*)(F &, G &, T);
+
+	template <T N>
+	static constexpr result hit(F &f, G &, T) {
+		return f.template operator() <N> ();
+	}
+
+	static constexpr result miss(F &, G &g, T x) {
+		return g(x);
+	}
+
+	static constexpr T lo = [] {
+		T out = keys[0];
+		for (T x : keys)
+			out = x < out ? x : out;
+
+		return out;
+	} ();
+
+	static constexpr uint64_t last = [] {
+		uint64_t out = 0;
+		for (T x : keys)
+			out = impl_offset(x, lo) > out ? impl_offset(x, lo) : out;
+
+		return out;
+	} ();
+
+	static constexpr bool direct = (last < 64 || last < 8 * count);
+
+	// Up to 16 slots per candidate, trying a few thousand odd multipliers
+	// for each table size
+	static constexpr impl_hash hash = [] {
+		if (direct)
+			return impl_hash {0, 0};
+
+		constexpr int least = std::bit_width(count - 1) > 0 ? std::bit_width(count - 1) : 1;
+		for (int bits = least; bits <= least + 4; bits++) {
+			for (uint64_t t = 0; t < 4096; t++) {
+				impl_hash h {0x9E3779B97F4A7C15ull * (2 * t + 1), bits};
+				std::array <bool, (size_t(1) << (least + 4))> used {};
+				bool perfect = true;
+				for (size_t i = 0; i < count && perfect; i++) {
+					perfect = !used[h(keys[i])];
+					used[h(keys[i])] = true;
+				}
+
+				if (perfect)
+					return h;
+			}
+		}
+
+		return impl_hash {0, 0};
+	} ();
+
+	static_assert(direct || hash.bits, "dispatch: no perfect hash for the candidates");
+
+	static constexpr size_t slots = direct ? last + 2 : size_t(1) << hash.bits;
+
+	static constexpr std::array <thunk, slots> table = [] {
+		std::array <thunk, slots> out {};
+		out.fill(&miss);
+		if constexpr (direct)
+			((out[impl_offset(Values, lo)] = &hit <Values>), ...);
+		else
+			((out[hash(Values)] = &hit <Values>), ...);
+
+		return out;
+	} ();
+
+	// Keys of the hashed slots; empty slots hold misses anyway
+	static constexpr std::array <T, slots> slot_keys = [] {
+		std::array <T, slots> out {};
+		if constexpr (!direct)
+			((out[hash(Values)] = Values), ...);
+
+		return out;
+	} ();
+
+	static constexpr result call(T x, F &f, G &g) {
+		if constexpr (direct) {
+			uint64_t offset = impl_offset(x, lo);
+			return table[offset <= last ? offset : last + 1](f, g, x);
+		} else {
+			size_t h = hash(x);
+			return (slot_keys[h] == x ? table[h] : &miss)(f, g, x);
+		}
+	}
+};
+
+}
+
+// Calls f.template operator() <N> () for the candidate N equal to x, from a
+// list of integers, or fallback(x) if there is none
+template <typename List, typename F, typename G>
+constexpr decltype(auto) dispatch(typename data::impl_candidates <List> ::type x, F &&f, G &&fallback)
+{
+	using impl = data::impl_dispatch <List, std::remove_reference_t <F>, std::remove_reference_t <G>>;
+	return impl::call(x, f, fallback);
+}
+
+// Misses return a value-initialized result
+template <typename List, typename F>
+constexpr decltype(auto) dispatch(typename data::impl_candidates <List> ::type x, F &&f)
+{
+	using key = typename data::impl_candidates <List> ::type;
+	using result = typename data::impl_candidates <List> ::template result <std::remove_reference_t <F>>;
+	auto fallback = [](key) {
+		return result();
+	};
+
+	return dispatch <List> (x, f, fallback);
+}
+
 // Language utilities
 namespace lang {
 
@@ -1,8 +1,12 @@
 #include "metacpp.hpp"
 #include "lisp.hpp"
+#include "metacpp_units.hpp"
+#include "example.lisp.hpp"
 
+#include <algorithm>
 #include <stdio.h>
 #include <typeinfo>
+#include <vector>
 
 // Testing lists
 namespace test_lists {
@@ -62,6 +66,304 @@ static_assert(
 	&& std::is_same_v <i2, char>
 );
 
+// Indexing does not recurse, so lists may exceed -ftemplate-depth
+template <typename>
+struct wide_list {};
+
+template <size_t ... Is>
+struct wide_list <std::index_sequence <Is...>> {
+	using type = metacpp::data::generic_list <metacpp::data::list <int, Is>...>;
+};
+
+using generic_list2 = wide_list <std::make_index_sequence <2000>> ::type;
+
+static_assert(std::is_same_v <metacpp::index_t <generic_list2, 1500>, metacpp::data::list <int, 1500>>);
+
+}
+
+namespace test_tables {
+
+using metacpp::data::list;
+
+constexpr uint32_t crc_entry(size_t i)
+{
+	uint32_t c = i;
+	for (int k = 0; k < 8; k++)
+		c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+
+	return c;
+}
+
+constexpr const auto &crc_table = metacpp::make_table <crc_entry, 256, uint32_t, 64>;
+
+static_assert(crc_table.size() == 256 && alignof(decltype(crc_table)) == 64);
+static_assert(crc_table[1] == 0x77073096u && crc_table[255] == 0x2D02EF8Du);
+
+constexpr uint32_t crc32(std::string_view text)
+{
+	uint32_t c = ~0u;
+	for (char x : text)
+		c = crc_table[(c ^ (unsigned char) x) & 0xFF] ^ (c >> 8);
+
+	return ~c;
+}
+
+static_assert(crc32("123456789") == 0xCBF43926u);
+
+// Quantization steps over a shape, narrowed to bytes
+constexpr auto quantization = [](size_t i, size_t j) { return 1 + 2 * (i + j); };
+constexpr const auto &steps = metacpp::make_grid <quantization, list <size_t, 8, 8>, uint8_t>;
+
+static_assert(std::is_same_v <decltype(steps), const metacpp::data::table <uint8_t, 1, 8, 8> &>);
+static_assert(steps(0, 0) == 1 && steps(3, 4) == 15 && steps(7, 7) == 29 && steps[8] == 3);
+
+// Over the elements of a list
+constexpr auto square = [](int x) { return x * x; };
+static_assert(metacpp::make_table_of <square, list <int, 3, 5, 7>> [2] == 49);
+
+// 64K entries are evaluated in chunks, each within the constexpr limits
+constexpr uint16_t reverse_bits(size_t i)
+{
+	uint16_t r = 0;
+	for (int k = 0; k < 16; k++)
+		r |= ((i >> k) & 1) << (15 - k);
+
+	return r;
+}
+
+constexpr const auto &reversed = metacpp::make_table <reverse_bits, 1 << 16>;
+
+static_assert(reversed.size() == 65536);
+static_assert(reversed[1] == 0x8000 && reversed[0x1234] == 0x2C48 && reversed[65535] == 0xFFFF);
+
+void rt_main()
+{
+	printf("crc32: %08x\n", crc32("metacpp"));
+}
+
+}
+
+namespace test_layouts {
+
+template <typename>
+struct tiers {};
+
+// Sorted, with every value twice
+template <size_t ... Is>
+struct tiers <std::index_sequence <Is...>> {
+	using type = metacpp::data::list <int, int(Is / 2 * 3)...>;
+};
+
+using prices = tiers <std::make_index_sequence <1000>> ::type;
+constexpr const auto &sorted = metacpp::data::impl_sorted_list <prices> ::elements;
+
+constexpr const auto &eytzinger = metacpp::make_eytzinger <prices>;
+constexpr const auto &btree = metacpp::make_btree <prices>;
+
+static_assert(alignof(decltype(eytzinger)) == 64 && btree.lanes == 16 && btree.blocks == 63);
+
+template <typename Layout>
+constexpr bool matches(const Layout &layout)
+{
+	for (int x = -1; x <= sorted.back() + 1; x++) {
+		size_t expected = std::lower_bound(sorted.begin(), sorted.end(), x) - sorted.begin();
+		if (layout.lower_bound(x) != expected)
+			return false;
+	}
+
+	return true;
+}
+
+static_assert(matches(eytzinger) && matches(btree));
+static_assert(eytzinger.lower_bound(3) == 2 && btree.lower_bound(3) == 2);
+
+// A full price table, checked against std::lower_bound at runtime
+using catalog = tiers <std::make_index_sequence <100000>> ::type;
+constexpr const auto &catalog_sorted = metacpp::data::impl_sorted_list <catalog> ::elements;
+
+constexpr const auto &catalog_eytzinger = metacpp::make_eytzinger <catalog>;
+constexpr const auto &catalog_btree = metacpp::make_btree <catalog>;
+
+static_assert(catalog_eytzinger.lower_bound(149997) == 99998 && catalog_btree.lower_bound(149997) == 99998);
+static_assert(catalog_eytzinger.lower_bound(149998) == 100000 && catalog_btree.lower_bound(149998) == 100000);
+static_assert(catalog_eytzinger.lower_bound(-1) == 0 && catalog_btree.lower_bound(75001) == 50002);
+
+// Small lists, and other element types
+using reals = metacpp::data::list <double, -1.5, 0.25, 0.25, 8.0>;
+static_assert(metacpp::make_eytzinger <reals> .lower_bound(0.25) == 1);
+static_assert(metacpp::make_btree <reals> .lower_bound(0.3) == 3);
+static_assert(metacpp::make_btree <reals> .lower_bound(9.0) == 4);
+static_assert(metacpp::make_eytzinger <metacpp::data::list <int, 7>> .lower_bound(8) == 1);
+
+// Unsorted lists have no layout
+template <typename List>
+concept has_layout = requires { metacpp::make_eytzinger <List>; };
+
+static_assert(!has_layout <metacpp::data::list <int, 2, 1>>);
+
+void rt_main()
+{
+	bool same = true;
+	unsigned int seed = 1;
+	for (int i = 0; i < 100000; i++) {
+		seed = seed * 1103515245 + 12345;
+		int x = (seed >> 8) % 1600 - 50;
+		size_t expected = std::lower_bound(sorted.begin(), sorted.end(), x) - sorted.begin();
+		same &= (eytzinger.lower_bound(x) == expected && btree.lower_bound(x) == expected);
+
+		x = (seed >> 4) % 150100 - 50;
+		expected = std::lower_bound(catalog_sorted.begin(), catalog_sorted.end(), x) - catalog_sorted.begin();
+		same &= (catalog_eytzinger.lower_bound(x) == expected && catalog_btree.lower_bound(x) == expected);
+	}
+
+	printf("layouts: %s\n", same ? "match" : "differ");
+}
+
+}
+
+namespace test_range_map {
+
+using metacpp::data::list;
+using metacpp::data::generic_list;
+using metacpp::data::range_strategy;
+
+// Character classes of a tokenizer, in any order; letters are split in
+// ranges with the same class, which are merged
+enum token_class : int { other, digit, letter, space };
+
+using classes = generic_list <
+	list <int, 'a', 'm', letter>,
+	list <int, '0', '9', digit>,
+	list <int, 'n', 'z', letter>,
+	list <int, 'A', 'Z', letter>,
+	list <int, ' ', ' ', space>,
+	list <int, '\t', '\n', space>
+>;
+
+constexpr const auto &classify = metacpp::range_map <classes>;
+
+static_assert(classify.strategy == range_strategy::direct);
+static_assert(metacpp::data::impl_range_map <classes, 0> ::count == 5);
+static_assert(classify('q') == letter && classify('m') == letter && classify('7') == digit);
+static_assert(classify('\n') == space && classify('_') == other && classify(-5) == other && classify(1000) == other);
+
+// Error codes in sparse blocks, with a default for the others
+using errors = generic_list <
+	list <int, 1000, 1099, 1>,
+	list <int, 1100, 1199, 1>,
+	list <int, 40000, 40999, 2>,
+	list <int, 70000, 70001, 3>
+>;
+
+constexpr const auto &severity = metacpp::range_map <errors, -1>;
+
+static_assert(severity.strategy == range_strategy::paged);
+
+// Pages of the same value share blocks: the default, one of errors 2, and
+// the four pages with a boundary
+static_assert(metacpp::data::impl_range_map <errors, -1> ::blocks == 6);
+static_assert(severity(1000) == 1 && severity(1150) == 1 && severity(1200) == -1 && severity(999) == -1);
+static_assert(severity(40500) == 2 && severity(70001) == 3 && severity(70002) == -1 && severity(-3) == -1);
+
+// Wider domains are searched
+using ports = generic_list <
+	list <long int, 0, 1023, 1>,
+	list <long int, 1024, 49151, 2>,
+	list <long int, 49152, 65535, 3>,
+	list <long int, 1l << 40, (1l << 40) + 5, 4>
+>;
+
+constexpr const auto &port_kind = metacpp::range_map <ports>;
+
+static_assert(port_kind.strategy == range_strategy::search);
+static_assert(port_kind(80) == 1 && port_kind(8080) == 2 && port_kind(65535) == 3 && port_kind(65536) == 0);
+static_assert(port_kind((1l << 40) + 5) == 4 && port_kind(-1) == 0);
+
+// Every strategy agrees with the others
+template <typename Ranges>
+constexpr bool agrees(long int begin, long int end)
+{
+	using map = metacpp::data::impl_range_map <Ranges, 0>;
+	for (long int x = begin; x < end; x++) {
+		if (map::search(x) != metacpp::range_map <Ranges> (x))
+			return false;
+	}
+
+	return true;
+}
+
+static_assert(agrees <classes> (-300, 300) && agrees <errors> (0, 72000));
+
+}
+
+namespace test_dispatch {
+
+using metacpp::data::list;
+
+// Kernels specialized for block sizes
+struct block_kernel {
+	template <int N>
+	constexpr int operator()() const {
+		return N * 10;
+	}
+};
+
+using blocks = list <int, 1, 2, 4, 8, 16>;
+
+constexpr int unsupported(int x)
+{
+	return -x;
+}
+
+static_assert(metacpp::data::impl_dispatch <blocks, block_kernel, decltype(unsupported)> ::direct);
+static_assert(metacpp::dispatch <blocks> (4, block_kernel {}, unsupported) == 40);
+static_assert(metacpp::dispatch <blocks> (16, block_kernel {}, unsupported) == 160);
+static_assert(metacpp::dispatch <blocks> (3, block_kernel {}, unsupported) == -3);
+static_assert(metacpp::dispatch <blocks> (-1, block_kernel {}) == 0 && metacpp::dispatch <blocks> (17, block_kernel {}) == 0);
+
+// Sparse candidates are hashed
+using channels = list <int, 1, 3, 100, 4096, 65536, -7, 1000000>;
+using hashed = metacpp::data::impl_dispatch <channels, block_kernel, decltype(unsupported)>;
+
+static_assert(!hashed::direct && hashed::slots >= 8);
+
+constexpr bool dispatches_all()
+{
+	for (int x : hashed::keys) {
+		if (metacpp::dispatch <channels> (x, block_kernel {}, unsupported) != x * 10)
+			return false;
+	}
+
+	for (int x : {0, 2, 4, 99, 4097, 65535, -1, 999999}) {
+		if (metacpp::dispatch <channels> (x, block_kernel {}, unsupported) != -x)
+			return false;
+	}
+
+	return true;
+}
+
+static_assert(dispatches_all());
+
+// Kernels may keep state, and return nothing
+struct counter {
+	int total = 0;
+
+	template <int N>
+	void operator()() {
+		total += N;
+	}
+};
+
+void rt_main()
+{
+	counter c;
+	int misses = 0;
+	for (int x : {1, 2, 3, 8, 100, 65536})
+		metacpp::dispatch <channels> (x, c, [&](int) { misses++; });
+
+	printf("dispatch: total %d, misses %d\n", c.total, misses);
+}
+
 }
 
 namespace test_lang_string {
@@ -229,11 +531,738 @@ constexpr char lisp_source[] = R"(
 constexpr metacpp::data::constexpr_string lisp_source_str(lisp_source, sizeof(lisp_source) - 1);
 using results = typename lisp::eval_t <lisp_source_str>;
 
-// TODO: branching
+// Arithmetic promotion is decided once over all operands
+namespace test_lisp_arithmetic {
+
+constexpr char mixed_source[] = "(+ 1 2 3.5) (* 1 2 3 4) (* 2 0.5 4)";
+constexpr metacpp::data::constexpr_string mixed_source_str(mixed_source, sizeof(mixed_source) - 1);
+
+static_assert(std::is_same_v <
+	lisp::eval_t <mixed_source_str>,
+	metacpp::data::generic_list <lisp::Float <6.5>, lisp::Int <24>, lisp::Float <4.0>>
+>);
+
+}
+
+// Compact evaluation, keyed on program IDs
+LISP_PROGRAM(0, "(list 1.05 2.77 (list 3.14 2.71) (+ 1 2) (- 3.5 (* 3 1.5)))");
+LISP_PROGRAM(1, "1 -2 (/ 6 3) (/ 7 2) (* 2 (+ 1 2 3.5))");
+LISP_PROGRAM(2, "(+ 1 2 3.5) (* 1 2 3 4) (* 2 0.5 4)");
+
+namespace test_lisp_program {
+
+static_assert(std::is_same_v <lisp::program_eval_t <0>, results>);
+
+static_assert(std::is_same_v <
+	lisp::program_eval_t <1>,
+	metacpp::data::generic_list <
+		lisp::Int <1>, lisp::Int <-2>, lisp::Int <2>,
+		lisp::Float <3.5>, lisp::Float <13.0>
+	>
+>);
+
+static_assert(std::is_same_v <lisp::program_eval_t <2>, lisp::eval_t <test_lisp_arithmetic::mixed_source_str>>);
+
+}
+
+// Value trees, readable at runtime
+namespace test_lisp_values {
+
+constexpr char source[] = "(list 1 2.5 (list 3)) (+ 1 2)";
+constexpr metacpp::data::constexpr_string source_str(source, sizeof(source) - 1);
+
+constexpr lisp::value_view values = lisp::eval_v <source_str>;
+
+static_assert(values.size() == 2);
+static_assert(values[0].size() == 3);
+static_assert(values[0][0].is_integer() && values[0][0].integer() == 1);
+static_assert(values[0][1].is_real() && values[0][1].real() == 2.5);
+static_assert(values[0][2].is_list() && values[0][2][0].integer() == 3);
+static_assert(values[1].integer() == 3);
+
+void rt_main()
+{
+	long int sum = 0;
+	for (lisp::value_view element : values[0]) {
+		if (element.is_integer())
+			sum += element.integer();
+	}
+
+	printf("values: %s, integer sum: %ld\n", metacpp::io::to_string(values).c_str(), sum);
+}
+
+}
+
+// Conditionals; the untaken branches would fail if they were evaluated
+LISP_PROGRAM(3, R"(
+(if (< 1 2) 10 (/ 1 0))
+(cond ((> 1 2) (/ 1 0)) ((= 2 2.0) (+ 1 1)) (else (/ 1 0)))
+(and (< 1 2 3) #f (/ 1 0))
+(or #f 3 (/ 1 0))
+(not (if #f 1))
+)");
+
+// Bindings, evaluated once and shared by every reference
+LISP_PROGRAM(4, R"(
+(let ((x 2) (y 3.5)) (+ x y x))
+(let* ((a 1) (b (+ a 1)) (c (* b b))) (list a b c))
+(let ((x 1)) (let ((x 10) (y x)) (+ x y)))
+)");
+
+// Functions; calls are memoized, so naive recursion stays linear
+LISP_PROGRAM(5, R"(
+(defun fib (n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))
+(defun twice (f x) (f (f x)))
+(fib 40)
+(twice (lambda (x) (* x x)) 3)
+(let ((add (lambda (a) (lambda (b) (+ a b))))) ((add 3) 4.5))
+)");
+
+// Iteration; neither tail calls, (loop ...) nor (do ...) grow the depth of
+// constexpr calls, and non-tail recursion is only bounded by memory
+LISP_PROGRAM(6, R"(
+(defun count (n acc) (if (= n 0) acc (count (- n 1) (+ acc 1))))
+(defun sum (n) (if (= n 0) 0 (+ n (sum (- n 1)))))
+(count 600 0)
+(sum 600)
+(loop ((i 0) (s 0)) (if (= i 100) s (recur (+ i 1) (+ s i))))
+(do ((i 1 (+ i 1)) (p 1 (* p i))) ((> i 10) p))
+)");
+
+// Lists; builtins that evaluate their operands are also functions
+LISP_PROGRAM(7, R"(
+(defun range (n) (do ((i n (- i 1)) (l '() (cons (- i 1) l))) ((= i 0) l)))
+(cons 0 '(1 2))
+(list (car '(1 2)) (cdr '(1 2)) (nth 2 '(5 6 7)) (length (range 4)))
+(append '(1) '() (list 2.5 '(#t)))
+(map (lambda (x) (* x x)) (range 4))
+(reduce + 0 (range 300))
+)");
+
+// Integers beyond long int are exact bignums
+LISP_PROGRAM(9, R"(
+(defun fact (n) (if (= n 0) 1 (* n (fact (- n 1)))))
+(fact 25)
+(expt 2 100)
+(/ (fact 30) (fact 28))
+(- (+ 9223372036854775807 1) 1)
+(list (< (expt 2 64) (expt 2 65)) (= (expt 2 64) (* (expt 2 32) (expt 2 32))))
+(/ (expt 2 70) 4096.0)
+(/ (expt 3 5000) (expt 3 4998))
+(expt 1.5 2)
+)");
+
+// Vectors of reals, e.g. lookup curves and filter taps
+LISP_PROGRAM(10, R"(
+(defun taps (n) (make-vector n (lambda (i) (/ 1.0 n))))
+#(1 2.5 (+ 1 2))
+(make-vector 3 0.5)
+(make-vector 5 (lambda (i) (* i i)))
+(map (lambda (x) (* 2 x)) (taps 4))
+(list (vector-ref #(1.5 2.5) 1) (length (taps 3)) (reduce + 0 #(1 2 3.5)))
+'(#(1 2) 3)
+)");
+
+// Queries over tables from CSV text
+constexpr char sales_csv[] = R"(region, product, units, price
+1, 10, 5, 2.5
+2, 10, 3, 2.5
+1, 11, 7, 1.25
+3, 12, 1, 10
+2, 11, 4, 1.25
+)";
+
+LISP_PROGRAM_TABLES(11, R"(
+(defun revenue (t) (sum t (lambda (region product units price) (* units price))))
+(sum sales 2)
+(select (sort-by sales 3) 3 2)
+(where sales (lambda (region product units price) (> units 3)))
+(map (lambda (g) (list (car g) (revenue (nth 1 g)))) (group-by sales 0))
+(length (car (where sales (lambda (region product units price) (= product 10)))))
+)", lisp::table { "sales", sales_csv });
+
+// Strings and symbols
+LISP_PROGRAM(12, R"(
+(defun route (method path) (concat (symbol->string method) " " path))
+"hello"
+(concat "a" "b" "c")
+(substr "compile time" 8)
+(list (length "abc") (equal? "ab" (substr "cab" 1)) (equal? '(a 1) '(a 1)) (equal? 'a "a"))
+(map (lambda (m) (route m "/users")) '(GET POST))
+(string->symbol (concat "handler_" (number->string 3)))
+"say \"hi\""
+)");
+
+// Modules; importers see their definitions, but do not evaluate their forms
+LISP_PROGRAM(13, R"(
+(defun square (x) (* x x))
+(defun norm2 (x y) (+ (square x) (square y)))
+(norm2 3 4)
+)");
+
+LISP_PROGRAM(14, R"(
+(defun greet (name) (concat "hello " name))
+)");
+
+LISP_PROGRAM_IMPORTS(15, R"(
+(defun cube (x) (* x (square x)))
+(norm2 1 2)
+(cube 3)
+(greet "modules")
+)", 13, 14);
+
+namespace test_lisp_forms {
+
+static_assert(std::is_same_v <
+	lisp::program_eval_t <3>,
+	metacpp::data::generic_list <
+		lisp::Int <10>, lisp::Int <2>, lisp::Bool <false>,
+		lisp::Int <3>, lisp::Bool <true>
+	>
+>);
+
+static_assert(std::is_same_v <
+	lisp::program_eval_t <4>,
+	metacpp::data::generic_list <
+		lisp::Float <7.5>,
+		metacpp::data::generic_list <lisp::Int <1>, lisp::Int <2>, lisp::Int <4>>,
+		lisp::Int <11>
+	>
+>);
+
+static_assert(std::is_same_v <
+	lisp::program_eval_t <5>,
+	metacpp::data::generic_list <lisp::Int <102334155>, lisp::Int <81>, lisp::Float <7.5>>
+>);
+
+static_assert(std::is_same_v <
+	lisp::program_eval_t <6>,
+	metacpp::data::generic_list <
+		lisp::Int <600>, lisp::Int <180300>, lisp::Int <4950>, lisp::Int <3628800>
+	>
+>);
+
+static_assert(std::is_same_v <
+	lisp::program_eval_t <7>,
+	metacpp::data::generic_list <
+		metacpp::data::generic_list <lisp::Int <0>, lisp::Int <1>, lisp::Int <2>>,
+		metacpp::data::generic_list <
+			lisp::Int <1>, metacpp::data::generic_list <lisp::Int <2>>,
+			lisp::Int <7>, lisp::Int <4>
+		>,
+		metacpp::data::generic_list <
+			lisp::Int <1>, lisp::Float <2.5>,
+			metacpp::data::generic_list <lisp::Bool <true>>
+		>,
+		metacpp::data::generic_list <lisp::Int <0>, lisp::Int <1>, lisp::Int <4>, lisp::Int <9>>,
+		lisp::Int <44850>
+	>
+>);
+
+}
+
+// Step counts and budgets
+namespace test_lisp_fuel {
+
+// A literal takes a single step, and each call at least one
+static_assert(lisp::program_steps_v <1> .forms.size() == 5);
+static_assert(lisp::program_steps_v <1> .forms[0] == 1);
+static_assert(lisp::program_steps_v <6> .forms[0] > 600);
+static_assert(lisp::program_steps_v <1> .parse == 19);
+
+// Single forms count only their own steps, whatever their value
+static_assert(lisp::program_form_steps_v <1, 0> .forms.size() == 1);
+static_assert(lisp::program_form_steps_v <1, 4> .forms[0] == lisp::program_steps_v <1> .forms[4]);
+static_assert(lisp::program_form_steps_v <6, 0> .forms[0] == lisp::program_steps_v <6> .forms[0]);
+
+// Exactly enough fuel to parse 5 nodes and evaluate in a single step, as
+// operands that are literals or symbols are not separate steps
+constexpr char small_source[] = "(+ 1 2)";
+constexpr metacpp::data::constexpr_string small_source_str(small_source, sizeof(small_source) - 1);
+
+static_assert(lisp::eval_steps_v <small_source_str> .total() == 6);
+static_assert(std::is_same_v <
+	lisp::eval_t <small_source_str, 6>,
+	metacpp::data::generic_list <lisp::Int <3>>
+>);
+
+}
+
+namespace test_lisp_compile {
+
+constexpr char formula[] = "(+ (* 3 x) (/ y 2.0) (* 2 (let ((k 5)) (+ k 1))))";
+constexpr metacpp::data::constexpr_string formula_str(formula, sizeof(formula) - 1);
+
+constexpr char clamp[] = "(if (< x 0) 0 (if (> x limit) limit x))";
+constexpr metacpp::data::constexpr_string clamp_str(clamp, sizeof(clamp) - 1);
+
+constexpr char folded[] = "(if (= (length '(1 2 3)) 3) (* x 2) undefined)";
+constexpr metacpp::data::constexpr_string folded_str(folded, sizeof(folded) - 1);
+
+constexpr char x[] = "x", y[] = "y", limit[] = "limit";
+constexpr metacpp::data::constexpr_string x_str(x, 1);
+constexpr metacpp::data::constexpr_string y_str(y, 1);
+constexpr metacpp::data::constexpr_string limit_str(limit, 5);
+
+using formula_t = lisp::compile <formula_str, lisp::args <x_str, y_str>>;
+using clamp_t = lisp::compile <clamp_str, lisp::args <x_str, limit_str>>;
+using folded_t = lisp::compile <folded_str, lisp::args <x_str>>;
+
+// The let is folded into a single constant operand
+static_assert(formula_t::impl_type::partial.residual[formula_t::impl_type::partial.root].count == 3);
+static_assert(formula_t {} (2, 5.0) == 20.5);
+static_assert(std::is_same_v <decltype(formula_t {} (2, 5.0)), double>);
+
+static_assert(clamp_t {} (-3, 10) == 0);
+static_assert(clamp_t {} (4, 10) == 4);
+static_assert(clamp_t {} (12, 10) == 10);
+static_assert(std::is_same_v <decltype(clamp_t {} (1, 2)), long int>);
+
+// The untaken branch is never evaluated
+static_assert(folded_t {} (21) == 42);
+
+// A constant test that fails is an error, not a false condition
+constexpr char failing[] = "(if (car '()) x 2)";
+constexpr metacpp::data::constexpr_string failing_str(failing, sizeof(failing) - 1);
+
+constexpr lisp::status failing_parsed = lisp::impl_parse(failing_str, nullptr);
+constexpr auto failing_nodes = lisp::impl_parse_nodes <failing_parsed.size> (failing_str);
+constexpr auto failing_partial = lisp::impl_partial_evaluate <failing_parsed.size> (
+	failing_str, failing_nodes.data(), &x_str, 1
+);
+
+static_assert(failing_partial.state.error == lisp::error_code::type);
+static_assert(lisp::runtime::eval(failing).state.error == lisp::error_code::type);
+
+}
+
+namespace test_lisp_kernel {
+
+constexpr char axpy[] = "(+ (* a x) y)";
+constexpr metacpp::data::constexpr_string axpy_str(axpy, sizeof(axpy) - 1);
+
+constexpr char relu[] = "(if (> x 0) (* x (+ 1 1)) 0)";
+constexpr metacpp::data::constexpr_string relu_str(relu, sizeof(relu) - 1);
+
+constexpr char a[] = "a", x[] = "x", y[] = "y";
+constexpr metacpp::data::constexpr_string a_str(a, 1);
+constexpr metacpp::data::constexpr_string x_str(x, 1);
+constexpr metacpp::data::constexpr_string y_str(y, 1);
+
+using axpy_t = lisp::kernel <axpy_str, lisp::args <a_str, x_str, y_str>>;
+using relu_t = lisp::kernel <relu_str, lisp::args <x_str>>;
+
+static_assert(axpy_t::vectorizable && relu_t::vectorizable);
+
+constexpr std::array <double, 6> xs { 1, -2, 3, -4, 5, 6 };
+constexpr std::array <double, 6> ys { 0.5, 0.5, 0.5, 0.5, 0.5, 0.5 };
+
+constexpr std::array <double, 6> axpy_out = [] {
+	std::array <double, 6> out {};
+	axpy_t {} (out, 2, xs, ys);
+	return out;
+} ();
+
+constexpr std::array <double, 6> relu_out = [] {
+	std::array <double, 6> out {};
+	relu_t {} (out, xs);
+	return out;
+} ();
+
+static_assert(axpy_out == std::array <double, 6> { 2.5, -3.5, 6.5, -7.5, 10.5, 12.5 });
+static_assert(relu_out == std::array <double, 6> { 2, 0, 6, 0, 10, 12 });
+
+}
+
+namespace test_lisp_parallel {
+
+using test_lisp_kernel::axpy_t;
+
+// Small chunks, so that several threads take part; sums must not depend on
+// the number of threads
+void rt_main()
+{
+	std::vector <double> xs(100000), ys(100000), serial(xs.size()), parallel(xs.size());
+	for (size_t i = 0; i < xs.size(); i++) {
+		xs[i] = 1.0 / (i + 1);
+		ys[i] = double(i % 7);
+	}
+
+	lisp::executor one { .threads = 1, .chunk = 1000, .threshold = 0 };
+	lisp::executor four { .threads = 4, .chunk = 1000, .threshold = 0 };
+
+	axpy_t {} (serial, 3, xs, ys);
+	four(axpy_t {}, parallel, 3, xs, ys);
+
+	double sum1 = one.sum(axpy_t {}, xs.size(), 3, xs, ys);
+	double sum4 = four.sum(axpy_t {}, xs.size(), 3, xs, ys);
+
+	printf("parallel kernel: %s, sum: %f, deterministic: %s\n",
+		serial == parallel ? "matches" : "differs",
+		sum4, sum1 == sum4 ? "yes" : "no");
+}
+
+}
+
+// Built with AVX2 in metacpp_simd.cpp, and only run where the CPU has it
+namespace test_lisp_simd {
+
+void rt_main();
+
+}
+
+namespace test_lisp_runtime {
+
+// The subsources of benchmark/config.json, repeated as many times as its scale
+template <const char *Source, size_t Size, size_t Copies = 5>
+struct corpus {
+	static constexpr std::array <char, Copies * (Size + 1)> text = [] {
+		std::array <char, Copies * (Size + 1)> text {};
+		for (size_t i = 0; i < Copies; i++) {
+			for (size_t j = 0; j < Size; j++)
+				text[i * (Size + 1) + j] = Source[j];
+
+			text[i * (Size + 1) + Size] = ' ';
+		}
+
+		return text;
+	} ();
+
+	static constexpr metacpp::data::constexpr_string value { text.data(), text.size() };
+};
+
+constexpr char list[] = "(list 1 2 3 4 5 6 7 8 9 10)";
+constexpr char sum_hi[] = "(+ 1 2 3 4 5 6 7 8 9 10)";
+constexpr char prod_hi[] = "(* 1 2 3 4 5 6 7 8 9 10)";
+constexpr char sum_if[] = "(+ 1 2 3.7 4 5 6.99 7 8.31 9 10.1)";
+constexpr char prod_if[] = "(* 1 2 3 4.3 5.5435 6 7 8 9.54 10)";
+constexpr char raw_i[] = "1 2 3 4 5 6 7 8 9 10";
+constexpr char raw_f[] = "1.1 2.2 3.3 4.4 5.5 6.6 7.7 8.8 9.9 10.1";
+
+template <const metacpp::data::constexpr_string &Str>
+constexpr bool agrees = [] {
+	lisp::runtime::result result = lisp::runtime::eval({ Str.str, Str.size });
+	return result.ok() && result.view() == lisp::eval_v <Str>;
+} ();
+
+static_assert(agrees <corpus <list, sizeof(list) - 1> ::value>);
+static_assert(agrees <corpus <sum_hi, sizeof(sum_hi) - 1> ::value>);
+static_assert(agrees <corpus <prod_hi, sizeof(prod_hi) - 1> ::value>);
+static_assert(agrees <corpus <sum_if, sizeof(sum_if) - 1> ::value>);
+static_assert(agrees <corpus <prod_if, sizeof(prod_if) - 1> ::value>);
+static_assert(agrees <corpus <raw_i, sizeof(raw_i) - 1> ::value>);
+static_assert(agrees <corpus <raw_f, sizeof(raw_f) - 1> ::value>);
+
+// The test programs, including definitions, loops and lists
+static_assert(agrees <lisp::program <1> ::value>);
+static_assert(agrees <lisp::program <3> ::value>);
+static_assert(agrees <lisp::program <4> ::value>);
+static_assert(agrees <lisp::program <5> ::value>);
+static_assert(agrees <lisp::program <7> ::value>);
+
+// Errors are reported instead of failing compilation
+static_assert(lisp::runtime::eval("(+ 1 2").state.error == lisp::error_code::parse);
+static_assert(lisp::runtime::eval("(+ 1 (/ 2 0))").state.error == lisp::error_code::divide_by_zero);
+static_assert(lisp::runtime::eval("(+ 1 (/ 2 0))").state.offset == 5);
+static_assert(lisp::runtime::eval("(+ 1 2)", 3).state.error == lisp::error_code::fuel);
+
+// Integer literals that do not fit in a long int
+static_assert(lisp::runtime::eval("(+ 1 9223372036854775808)").state.error == lisp::error_code::overflow);
+static_assert(lisp::runtime::eval("(+ 1 9223372036854775808)").state.offset == 5);
+static_assert(lisp::runtime::eval("-9223372036854775808").view()[0].integer() == std::numeric_limits <long int> ::min());
+static_assert(lisp::runtime::eval("99999999999999999999999").state.error == lisp::error_code::overflow);
+
+}
+
+namespace test_lisp_bytecode {
+
+constexpr char formula[] = "(+ (* 3 x) (/ y 2) (* 2 (let ((k 5)) (+ k 1))))";
+constexpr metacpp::data::constexpr_string formula_str(formula, sizeof(formula) - 1);
+
+constexpr char choose[] = "(if (and (> x 0) (not (= x limit))) x (or (< x 0) limit))";
+constexpr metacpp::data::constexpr_string choose_str(choose, sizeof(choose) - 1);
+
+using test_lisp_compile::x_str;
+using test_lisp_compile::y_str;
+using test_lisp_compile::limit_str;
+
+using formula_t = lisp::bytecode <formula_str, lisp::args <x_str, y_str>>;
+using choose_t = lisp::bytecode <choose_str, lisp::args <x_str, limit_str>>;
+
+// The let is folded into a constant
+static_assert(formula_t::program.size == 9);
+static_assert(formula_t::program.depth == 3);
+
+// Exact integer division stays an integer, as in the evaluator
+static_assert(formula_t {} (1, 4).result.kind == lisp::value_kind::integer);
+static_assert(formula_t {} (1, 4).result.integer == 17);
+static_assert(formula_t {} (1, 3).result.kind == lisp::value_kind::real);
+static_assert(formula_t {} (1, 3).result.real == 16.5);
+static_assert(formula_t {} (1, 0.5).result.real == 15.25);
+
+static_assert(choose_t {} (3, 10).result.integer == 3);
+static_assert(choose_t {} (10, 10).result.integer == 10);
+static_assert(choose_t {} (-1, 10).result.kind == lisp::value_kind::boolean);
+static_assert(choose_t {} (-1, 10).result.integer == 1);
+
+// Runtime errors are reported at the offending form
+static_assert(formula_t {} (1, true).state.error == lisp::error_code::type);
+static_assert(formula_t {} (1, true).state.offset == 11);
+
+// Without a heap there are no bignums
+static_assert(formula_t {} (9223372036854775807l, 4).state.error == lisp::error_code::overflow);
+
+}
+
+namespace test_lisp_units {
+
+// Forms evaluated on their own agree with the whole program
+static_assert(lisp::program_form_v <6, 1> == lisp::program_eval_v <6> [1]);
+static_assert(lisp::program_form_v <7, 3> == lisp::program_eval_v <7> [3]);
+static_assert(std::is_same_v <lisp::program_form_t <6, 3>, lisp::Int <3628800>>);
+
+// Program 8 is only evaluated in metacpp_units.cpp
+void rt_main()
+{
+	printf("units: %s, %s, %s\n",
+		metacpp::io::to_string(lisp::program_unit <8, 0> ::value).c_str(),
+		metacpp::io::to_string(lisp::program_unit <8, 1> ::value).c_str(),
+		metacpp::io::to_string(lisp::program_unit <8, 2> ::value).c_str());
+}
+
+}
+
+namespace test_lisp_generated {
+
+using example = lisp::generated::example;
+
+// The header generated from example.lisp agrees with the template evaluator
+static_assert(lisp::checksum(lisp::eval_v <example::source>) == example::checksum);
+static_assert(lisp::eval_v <example::source> == example::view);
+static_assert(std::is_same_v <lisp::eval_t <example::source>, example::type>);
+
+}
+
+namespace test_lisp_bignum {
+
+using lisp::bignum;
+
+constexpr bool factorial_25 = [] {
+	bignum x = 1;
+	for (long int i = 2; i <= 25; i++)
+		x = x * i;
+
+	return lisp::program_eval_v <9> [0].big() == x;
+} ();
+
+static_assert(factorial_25);
+static_assert(lisp::program_eval_v <9> [0].is_big());
+static_assert(lisp::program_eval_v <9> [1].big() == pow(bignum(2), 100));
+static_assert(std::is_same_v <
+	metacpp::index_t <lisp::program_eval_t <9>, 1>,
+	lisp::Big <false, 0, 0, 0, 16>
+>);
+
+static_assert(std::is_same_v <metacpp::index_t <lisp::program_eval_t <9>, 2>, lisp::Int <870>>);
+static_assert(std::is_same_v <metacpp::index_t <lisp::program_eval_t <9>, 3>, lisp::Int <9223372036854775807>>);
+static_assert(std::is_same_v <
+	metacpp::index_t <lisp::program_eval_t <9>, 4>,
+	metacpp::data::generic_list <lisp::Bool <true>, lisp::Bool <true>>
+>);
+
+static_assert(lisp::program_eval_v <9> [5].real() == 288230376151711744.0);
+static_assert(lisp::program_eval_v <9> [6].integer() == 9);
+static_assert(lisp::program_eval_v <9> [7].real() == 2.25);
+
+// Karatsuba against schoolbook multiplication, with signs and division
+constexpr bool karatsuba = [] {
+	bignum x = pow(bignum(-7), 400);
+	bignum y = pow(bignum(11), 350) - 1;
+	bignum product = x * y;
+	auto [quotient, remainder] = divmod(product + 5, y);
+	return product.limbs == bignum::schoolbook(x.limbs, y.limbs)
+		&& quotient == x && remainder == 5;
+} ();
+
+static_assert(karatsuba);
+
+void rt_main()
+{
+	printf("bignums: %s, %s\n",
+		metacpp::io::to_string(lisp::program_eval_v <9> [0]).c_str(),
+		metacpp::io::to_string <metacpp::index_t <lisp::program_eval_t <9>, 1>> ().c_str());
+}
+
+}
+
+namespace test_lisp_vectors {
+
+using metacpp::data::list;
+
+static_assert(std::is_same_v <metacpp::index_t <lisp::program_eval_t <10>, 0>, list <double, 1.0, 2.5, 3.0>>);
+static_assert(std::is_same_v <metacpp::index_t <lisp::program_eval_t <10>, 1>, list <double, 0.5, 0.5, 0.5>>);
+static_assert(std::is_same_v <
+	metacpp::index_t <lisp::program_eval_t <10>, 4>,
+	metacpp::data::generic_list <lisp::Float <2.5>, lisp::Int <3>, lisp::Float <6.5>>
+>);
+
+static_assert(std::is_same_v <
+	metacpp::index_t <lisp::program_eval_t <10>, 5>,
+	metacpp::data::generic_list <list <double, 1.0, 2.0>, lisp::Int <3>>
+>);
+
+// Elements are contiguous in rodata
+constexpr std::span <const double> squares = lisp::program_eval_v <10> [2].vector();
+constexpr std::span <const double> taps = lisp::program_eval_v <10> [3].vector();
+
+static_assert(squares.size() == 5 && squares[4] == 16.0);
+static_assert(taps.size() == 4 && taps[0] == 0.5 && taps[3] == 0.5);
+static_assert(taps.data() == squares.data() + squares.size());
+static_assert(lisp::program_eval_v <10> [2][3].real() == 9.0);
+
+static_assert(!lisp::runtime::eval("(vector 1 '(2))").ok());
+static_assert(!lisp::runtime::eval("(vector-ref #(1 2) 2)").ok());
+static_assert(lisp::runtime::eval("(make-vector 3 (lambda (i) (+ i 0.5)))").view()[0].vector()[2] == 2.5);
+
+void rt_main()
+{
+	double sum = 0;
+	for (double x : squares)
+		sum += x;
+
+	printf("vectors: %s, %s, sum %g, aligned %d\n",
+		metacpp::io::to_string(lisp::program_eval_v <10> [3]).c_str(),
+		metacpp::io::to_string <metacpp::index_t <lisp::program_eval_t <10>, 0>> ().c_str(),
+		sum, int(reinterpret_cast <uintptr_t> (lisp::program_eval_v <10> [0].vector().data()) % 64 == 0));
+}
+
+}
+
+namespace test_lisp_tables {
+
+using metacpp::data::list;
+using metacpp::data::generic_list;
+using lisp::Float;
+
+using queries = lisp::program_eval_t <11>;
+
+static_assert(std::is_same_v <metacpp::index_t <queries, 0>, Float <20.0>>);
+static_assert(std::is_same_v <
+	metacpp::index_t <queries, 1>,
+	generic_list <list <double, 1.25, 1.25, 2.5, 2.5, 10.0>, list <double, 7.0, 4.0, 5.0, 3.0, 1.0>>
+>);
+
+static_assert(std::is_same_v <
+	metacpp::index_t <queries, 3>,
+	generic_list <
+		generic_list <Float <1.0>, Float <21.25>>,
+		generic_list <Float <2.0>, Float <12.5>>,
+		generic_list <Float <3.0>, Float <10.0>>
+	>
+>);
+
+static_assert(std::is_same_v <metacpp::index_t <queries, 4>, lisp::Int <2>>);
+
+// Filtered columns are vectors too
+constexpr lisp::value_view filtered = lisp::program_eval_v <11> [2];
+static_assert(filtered.size() == 4 && filtered[0].vector().size() == 3);
+static_assert(filtered[0].vector()[2] == 2.0 && filtered[2].vector()[1] == 7.0);
+
+// The same tables at runtime; rows must have as many cells as the first
+constexpr lisp::table runtime_tables[] = { { "t", "1,2\n3,4\n" } };
+constexpr lisp::table ragged[] = { { "t", "1,2\n3\n" } };
+static_assert(lisp::runtime::eval("(sum t 1)", runtime_tables).view()[0].real() == 6.0);
+static_assert(lisp::runtime::eval("(sum t 0)", ragged).state.error == lisp::error_code::table);
+
+// sum as a function value, with a function argument of its own
+static_assert(lisp::runtime::eval(
+	"(list 5 ((lambda (f) (f t (lambda (a b) (* a b)))) sum) 7)", runtime_tables
+).view()[0] == lisp::runtime::eval("(list 5 14.0 7)").view()[0]);
+
+}
+
+namespace test_lisp_strings {
+
+using lisp::String;
+using strings = lisp::program_eval_t <12>;
+
+// Equal strings are the same type, whichever program made them
+static_assert(std::is_same_v <metacpp::index_t <strings, 0>, String <"hello">>);
+static_assert(std::is_same_v <metacpp::index_t <strings, 1>, String <"abc">>);
+static_assert(std::is_same_v <metacpp::index_t <strings, 2>, String <"time">>);
+static_assert(std::is_same_v <
+	metacpp::index_t <strings, 3>,
+	metacpp::data::generic_list <lisp::Int <3>, lisp::Bool <true>, lisp::Bool <true>, lisp::Bool <false>>
+>);
+
+static_assert(std::is_same_v <
+	metacpp::index_t <strings, 4>,
+	metacpp::data::generic_list <String <"GET /users">, String <"POST /users">>
+>);
+
+static_assert(std::is_same_v <metacpp::index_t <strings, 5>, lisp::Symbol <"handler_3">>);
+static_assert(std::is_same_v <metacpp::index_t <strings, 6>, String <"say \"hi\"">>);
+
+// Generated keys, e.g. for a lookup table
+constexpr lisp::value_view routes = lisp::program_eval_v <12> [4];
+
+constexpr int route_index(std::string_view key)
+{
+	for (int i = 0; i < routes.size(); i++) {
+		if (routes[i].text() == key)
+			return i;
+	}
+
+	return -1;
+}
+
+static_assert(route_index("POST /users") == 1 && route_index("PUT /users") == -1);
+static_assert(routes[1].text().data()[routes[1].text().size()] == '\0');
+
+static_assert(!lisp::runtime::eval("(substr \"abc\" 2 4)").ok());
+static_assert(!lisp::runtime::eval("(concat \"a\" 1)").ok());
+
+void rt_main()
+{
+	printf("strings: %s, %s\n",
+		metacpp::io::to_string(lisp::program_eval_v <12>).c_str(),
+		metacpp::io::to_string <metacpp::index_t <strings, 5>> ().c_str());
+}
+
+}
+
+namespace test_lisp_modules {
+
+static_assert(lisp::program_eval_v <13> .size() == 1 && lisp::program_eval_v <13> [0].integer() == 25);
+static_assert(std::is_same_v <
+	lisp::program_eval_t <15>,
+	metacpp::data::generic_list <lisp::Int <5>, lisp::Int <27>, lisp::String <"hello modules">>
+>);
+
+static_assert(lisp::program_form_v <15, 1> .integer() == 27);
+
+// Modules are parsed once; importers copy their nodes
+static_assert(lisp::impl_program <lisp::program <15>> ::nodes.size()
+	== lisp::impl_syntax <lisp::program <15>> ::nodes.size()
+		+ lisp::impl_syntax <lisp::program <13>> ::nodes.size() - 1
+		+ lisp::impl_syntax <lisp::program <14>> ::nodes.size() - 1);
+
+}
 
 int main()
 {
+	test_tables::rt_main();
+	test_layouts::rt_main();
+	test_dispatch::rt_main();
 	test_lang_list::rt_main();
+	test_lisp_values::rt_main();
+	test_lisp_parallel::rt_main();
+	if (__builtin_cpu_supports("avx2"))
+		test_lisp_simd::rt_main();
+	test_lisp_units::rt_main();
+	test_lisp_bignum::rt_main();
+	test_lisp_vectors::rt_main();
+	test_lisp_strings::rt_main();
 	printf("RESULTS: %s\n", metacpp::io::to_string <results> ().data());
 	return 0;
 }
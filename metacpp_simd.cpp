@@ -0,0 +1,67 @@
+#include "lisp.hpp"
+
+#include <stdio.h>
+
+#ifndef __AVX2__
+#error "metacpp_simd.cpp tests the explicit SIMD kernels, and must be built with -mavx2"
+#endif
+
+// Kernels run with AVX2 lanes at runtime, and with the scalar loop during
+// constant evaluation; both must give the same results
+namespace test_lisp_simd {
+
+constexpr char axpy[] = "(+ (* a x) y)";
+constexpr metacpp::data::constexpr_string axpy_str(axpy, sizeof(axpy) - 1);
+
+constexpr char ratio[] = "(/ (- x y) (+ x 2))";
+constexpr metacpp::data::constexpr_string ratio_str(ratio, sizeof(ratio) - 1);
+
+constexpr char step[] = "(if (< x y) (* x (+ 1 1)) (- y 0.5))";
+constexpr metacpp::data::constexpr_string step_str(step, sizeof(step) - 1);
+
+constexpr char pick[] = "(if (= x 3) a x)";
+constexpr metacpp::data::constexpr_string pick_str(pick, sizeof(pick) - 1);
+
+constexpr char a[] = "a", x[] = "x", y[] = "y";
+constexpr metacpp::data::constexpr_string a_str(a, 1);
+constexpr metacpp::data::constexpr_string x_str(x, 1);
+constexpr metacpp::data::constexpr_string y_str(y, 1);
+
+using axpy_t = lisp::kernel <axpy_str, lisp::args <a_str, x_str, y_str>>;
+using ratio_t = lisp::kernel <ratio_str, lisp::args <x_str, y_str>>;
+using step_t = lisp::kernel <step_str, lisp::args <x_str, y_str>>;
+using pick_t = lisp::kernel <pick_str, lisp::args <a_str, x_str>>;
+
+static_assert(axpy_t::vectorizable && ratio_t::vectorizable);
+static_assert(step_t::vectorizable && pick_t::vectorizable);
+
+// Not a multiple of the lanes, so that the scalar tail runs too
+constexpr size_t size = 11;
+
+constexpr std::array <double, size> xs { 1, -2.5, 3, -4.5, 5, 6, 3, 0.25, -9, 10, 3 };
+constexpr std::array <double, size> ys { 0.5, 7, -1, 2, 5, 8.5, 3, -0.75, 4, 1e9, -3 };
+
+template <typename Kernel, typename ... Ts>
+constexpr std::array <double, size> run(const Ts &... inputs)
+{
+	std::array <double, size> out {};
+	Kernel {} (out, inputs...);
+	return out;
+}
+
+void rt_main()
+{
+	constexpr auto axpy_scalar = run <axpy_t> (2.5, xs, ys);
+	constexpr auto ratio_scalar = run <ratio_t> (xs, ys);
+	constexpr auto step_scalar = run <step_t> (xs, ys);
+	constexpr auto pick_scalar = run <pick_t> (-1, xs);
+
+	bool same = (run <axpy_t> (2.5, xs, ys) == axpy_scalar)
+		&& (run <ratio_t> (xs, ys) == ratio_scalar)
+		&& (run <step_t> (xs, ys) == step_scalar)
+		&& (run <pick_t> (-1, xs) == pick_scalar);
+
+	printf("simd kernels: %s\n", same ? "match" : "differ");
+}
+
+}
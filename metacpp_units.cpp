@@ -0,0 +1,6 @@
+#include "metacpp_units.hpp"
+
+// Each unit could be in its own translation unit, to be compiled in parallel
+LISP_PROGRAM_UNIT(8, 0);
+LISP_PROGRAM_UNIT(8, 1);
+LISP_PROGRAM_UNIT(8, 2);
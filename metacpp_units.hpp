@@ -0,0 +1,16 @@
+#pragma once
+
+#include "lisp.hpp"
+
+// A program whose forms are evaluated in metacpp_units.cpp, and only read at
+// runtime elsewhere
+LISP_PROGRAM(8, R"(
+(defun range (n) (do ((i n (- i 1)) (l '() (cons (- i 1) l))) ((= i 0) l)))
+(reduce + 0 (range 2000))
+(loop ((i 0) (s 0)) (if (= i 3000) s (recur (+ i 1) (+ s (* i i)))))
+(map (lambda (x) (* x 1.5)) (range 4))
+)");
+
+LISP_PROGRAM_UNIT_EXTERN(8, 0);
+LISP_PROGRAM_UNIT_EXTERN(8, 1);
+LISP_PROGRAM_UNIT_EXTERN(8, 2);